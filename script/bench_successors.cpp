@@ -0,0 +1,116 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "myplan/grounding.h"
+#include "myplan/pddl/parser.h"
+#include "myplan/settrie.h"
+#include "myplan/successor_generator.h"
+
+using namespace std;
+
+/*
+Compare the applicable-operator throughput of the SetTrie that was used for
+successor generation and of the FlatSetTrie with the compiled
+SuccessorGenerator of the task.
+Usage: bench_successors domain.pddl task.pddl [num_states] [rounds]
+*/
+
+vector<State> sample_states(Task& task, int num_states) {
+    // states visited by random walks from the initial state
+    mt19937 rng(2023);
+    vector<State> states;
+    State state = task.initial_state;
+    vector<int> applicable;
+    while ((int)states.size() < num_states) {
+        states.push_back(state);
+        applicable.clear();
+        task.successor_generator.get_applicable_operators(state, applicable);
+        if (applicable.empty() || rng() % 50 == 0) {
+            state = task.initial_state;
+        } else {
+            state = task.operators[applicable[rng() % applicable.size()]].apply(
+                state);
+        }
+    }
+    return states;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Usage: %s domain.pddl task.pddl [num_states] [rounds]\n",
+               argv[0]);
+        return 1;
+    }
+    int num_states = argc > 3 ? stoi(argv[3]) : 2000;
+    int rounds = argc > 4 ? stoi(argv[4]) : 20;
+
+    Parser parser = Parser(argv[1], argv[2]);
+    Domain* domain = parser.parse_domain(true);
+    Problem problem = *parser.parse_problem(domain, true);
+    Task task = ground(problem);
+
+    SetTrie<int, int> settrie;
+    FlatSetTrie<int, int> flat_settrie;
+    for (int i = 0; i < (int)task.operators.size(); i++) {
+        const vector<int>& pre = task.operators[i].preconditions;
+        settrie.assign(set<int>(pre.begin(), pre.end()), i);
+        flat_settrie.assign(set<int>(pre.begin(), pre.end()), i);
+    }
+    vector<State> states = sample_states(task, num_states);
+
+    chrono::steady_clock::time_point start;
+    long long trie_ops = 0, flat_ops = 0, generator_ops = 0;
+    vector<int> applicable;
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (State& state : states) {
+            set<int> sorted_state(state.begin(), state.end());
+            applicable.clear();
+            settrie.subsets(sorted_state, applicable);
+            trie_ops += applicable.size();
+        }
+    }
+    double trie_sec =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    flat_settrie.num_nodes();  // build the pool outside the timed loop
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (State& state : states) {
+            set<int> sorted_state(state.begin(), state.end());
+            applicable.clear();
+            flat_settrie.subsets(sorted_state, applicable);
+            flat_ops += applicable.size();
+        }
+    }
+    double flat_sec =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (State& state : states) {
+            task.successor_generator.generate_applicable(
+                state, [&](int) { generator_ops++; });
+        }
+    }
+    double generator_sec =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (trie_ops != generator_ops || flat_ops != generator_ops) {
+        cerr << "Applicable operators differ: " << trie_ops << " vs "
+             << flat_ops << " vs " << generator_ops << endl;
+        return 1;
+    }
+    double queries = (double)num_states * rounds;
+    printf("%s %d operators %d nodes | settrie %.0f states/s | flat settrie "
+           "%.0f states/s | generator %.0f states/s | speedup %.2fx\n",
+           problem.name.c_str(), (int)task.operators.size(),
+           task.successor_generator.num_nodes(), queries / trie_sec,
+           queries / flat_sec, queries / generator_sec,
+           trie_sec / generator_sec);
+}
@@ -0,0 +1,9 @@
+
+# benchmark successor generation on the first task of every domain
+for dir in docs/benchmarks/*/; do
+    domain="${dir}domain.pddl"
+    if [ ! -f "$domain" ]; then
+        domain="${dir}domain01.pddl"
+    fi
+    timeout 300 ./build/script/bench_successors "$domain" "${dir}task01.pddl" "$@"
+done
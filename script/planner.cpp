@@ -1,12 +1,16 @@
+#include <getopt.h>
 #include <unistd.h>
 
 #include <cassert>
+#include <cstdio>
 #include <chrono>
 #include <fstream>
 #include <future>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -17,9 +21,20 @@
 #include "myplan/heuristic/base.h"
 #include "myplan/heuristic/landmarks.h"
 #include "myplan/heuristic/relaxation.h"
+#include "myplan/parallel_hashmap/meminfo.h"
 #include "myplan/pddl/parser.h"
+#include "myplan/search/anytime_search.h"
 #include "myplan/search/astar.h"
+#include "myplan/search/best_first_search.h"
 #include "myplan/search/breadth_first_search.h"
+#include "myplan/search/enforced_hill_climbing.h"
+#include "myplan/search/external_breadth_first_search.h"
+#include "myplan/search/frontier_search.h"
+#include "myplan/search/hda_star.h"
+#include "myplan/search/ida_star.h"
+#include "myplan/search/parallel_breadth_first_search.h"
+#include "myplan/search/portfolio.h"
+#include "myplan/search/sma_star.h"
 
 using namespace std;
 
@@ -28,12 +43,38 @@ string heuristic_type = "blind";
 string domain_file_path = "domain.pddl";
 string problem_file_path = "task.pddl";
 string solution_file_path = "task.soln";
+string open_list_type = "auto";
+string tie_breaking = "auto";
+float weight = 2;
+bool reopen_closed = true;
+bool lazy_evaluation = false;
+bool preferred_operators = false;
+int max_depth = numeric_limits<int>::max();
+ExternalSearchConfig external_config;
+int num_threads = max(1, (int)thread::hardware_concurrency());
+// in MiB, 0: a part of the available memory
+size_t memory_limit = 0;
+// in seconds, 0: no limit
+double time_limit = 0;
+// comma separated "algorithm[:heuristic[:seconds]]" entries
+string portfolio;
+// the number of states whose relaxed exploration is kept, 0: none
+int relaxation_cache = 0;
+
+const option long_options[] = {
+    {"memory-limit", required_argument, nullptr, 'M'},
+    {"time-limit", required_argument, nullptr, 'l'},
+    {"portfolio", required_argument, nullptr, 'F'},
+    {"relaxation-cache", required_argument, nullptr, 'C'},
+    {nullptr, 0, nullptr, 0},
+};
 
 void parse_args(int argc, char* argv[]) {
     int opt;
     domain_file_path = argv[1];
     problem_file_path = argv[2];
-    while ((opt = getopt(argc, argv, "s:H:o:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "s:H:o:q:w:t:j:d:T:b:D:M:l:F:C:RLpPO",
+                              long_options, nullptr)) != -1) {
         switch (opt) {
             case 's':
                 search_algorithm = string(optarg);
@@ -44,14 +85,246 @@ void parse_args(int argc, char* argv[]) {
             case 'o':
                 solution_file_path = string(optarg);
                 break;
+            case 'q':
+                open_list_type = string(optarg);
+                break;
+            case 'w':
+                weight = stof(optarg);
+                break;
+            case 't':
+                tie_breaking = string(optarg);
+                break;
+            case 'j':
+                num_threads = stoi(optarg);
+                break;
+            case 'd':
+                max_depth = stoi(optarg);
+                break;
+            case 'T':
+                external_config.directory = string(optarg);
+                break;
+            case 'b':
+                external_config.memory_bytes = stoul(optarg) << 20;
+                break;
+            case 'D':
+                external_config.duplicate_layers = stoi(optarg);
+                break;
+            case 'O':
+                external_config.direct_io = true;
+                break;
+            case 'M':
+                memory_limit = stoul(optarg);
+                break;
+            case 'l':
+                time_limit = stod(optarg);
+                break;
+            case 'F':
+                portfolio = string(optarg);
+                break;
+            case 'C':
+                relaxation_cache = stoi(optarg);
+                break;
+            case 'R':
+                reopen_closed = false;
+                break;
+            case 'L':
+                lazy_evaluation = true;
+                break;
+            case 'p':
+                preferred_operators = true;
+                break;
+            case 'P':
+                arena_huge_pages = true;
+                break;
             default:
                 printf("unknown parameter %s is specified", optarg);
-                printf("Usage: %s [-s] [-H] [-o] ...\n", argv[0]);
+                printf("Usage: %s [-s] [-H] [-o] [-q] [-w] [-t] [-j] [-d] [-T] [-b] [-D] [-M|--memory-limit] [-l|--time-limit] [-F|--portfolio] [-C|--relaxation-cache] [-R] [-L] [-p] [-P] [-O] ...\n", argv[0]);
                 break;
         }
     }
 }
 
+unique_ptr<Heuristic> make_heuristic(Task& task,
+                                     const string& heuristic_type) {
+    if (heuristic_type == "blind") {
+        return make_unique<BlindHeuristic>(task);
+    } else if (heuristic_type == "goalcount") {
+        return make_unique<GoalCountHeuristic>(task);
+    } else if (heuristic_type == "landmark") {
+        return make_unique<LandmarkHeuristic>(task);
+    } else if (heuristic_type == "hadd") {
+        return make_unique<hAddHeuristic>(task, relaxation_cache);
+    } else if (heuristic_type == "hmax") {
+        return make_unique<hMaxHeuristic>(task, relaxation_cache);
+    } else if (heuristic_type == "ff") {
+        return make_unique<hFFHeuristic>(task, relaxation_cache);
+    }
+    throw invalid_argument("given heuristic type is not supported");
+}
+
+/*
+The memory that can be allocated without swapping: MemAvailable of
+/proc/meminfo, or the physical memory not in use where it is missing.
+*/
+size_t available_memory() {
+    ifstream meminfo("/proc/meminfo");
+    string key;
+    size_t kib;
+    while (meminfo >> key >> kib) {
+        if (key == "MemAvailable:") {
+            return kib << 10;
+        }
+        meminfo.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    size_t physical = spp::GetPhysicalMemory();
+    size_t used = spp::GetTotalMemoryUsed();
+    return physical > used ? physical - used : 0;
+}
+
+// Write the plan to a temporary file and rename it, so that readers of
+// "path" never see a partial plan
+void write_solution(const Task& task, const string& path,
+                    const vector<int>& solution) {
+    string tmp_path = path + ".tmp";
+    ofstream solution_file(tmp_path, ios::out | ios::trunc);
+    for (int op : solution) {
+        solution_file << task.action_id2name.at(op) << "\n";
+    }
+    solution_file.close();
+    if (!solution_file || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        throw runtime_error("cannot write the solution file " + path);
+    }
+}
+
+/*
+Run the search "algorithm" on "search_task", with heuristics of type
+"heuristic_name" computed on the grounded "task". "start" is set when the
+search begins, after the heuristic has been constructed. Intermediate plans
+are written to "plan_path" followed by ".1", ".2", ...
+*/
+vector<int> run_search(Task& task, BaseTask& search_task,
+                       const string& algorithm, const string& heuristic_name,
+                       chrono::system_clock::time_point& start,
+                       const string& plan_path) {
+    BestFirstConfig config;
+    config.tie_breaking = tie_breaking;
+    config.reopen_closed = reopen_closed;
+    config.lazy = lazy_evaluation;
+    config.preferred_operators = preferred_operators;
+    if (algorithm == "bfs") {
+        start = chrono::system_clock::now();
+        return breadth_first_search(search_task);
+    } else if (algorithm == "ebfs") {
+        start = chrono::system_clock::now();
+        return external_breadth_first_search(search_task, external_config);
+    } else if (algorithm == "fbfs") {
+        start = chrono::system_clock::now();
+        return frontier_breadth_first_search(search_task, max_depth);
+    } else if (algorithm == "pbfs") {
+        start = chrono::system_clock::now();
+        return parallel_breadth_first_search(search_task, num_threads);
+    } else if (algorithm == "astar" || algorithm == "gbfs" ||
+               algorithm == "wastar") {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task, heuristic_name);
+        start = chrono::system_clock::now();
+        if (algorithm == "astar") {
+            return best_first_search(search_task, *heuristic, config,
+                                     open_list_type);
+        } else if (algorithm == "gbfs") {
+            return gbfs(search_task, *heuristic, config, open_list_type);
+        } else {
+            return wastar(search_task, *heuristic, weight, config,
+                          open_list_type);
+        }
+    } else if (algorithm == "ehc") {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task, heuristic_name);
+        start = chrono::system_clock::now();
+        return enforced_hill_climbing(search_task, *heuristic,
+                                      preferred_operators, open_list_type);
+    } else if (algorithm == "idastar") {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task, heuristic_name);
+        start = chrono::system_clock::now();
+        return ida_star(search_task, *heuristic);
+    } else if (algorithm == "smastar") {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task, heuristic_name);
+        size_t budget;
+        if (memory_limit > 0) {
+            size_t limit = memory_limit << 20;
+            size_t used = spp::GetProcessMemoryUsed();
+            printf("Memory limit %zu [MiB], %zu [MiB] in use\n", limit >> 20,
+                   used >> 20);
+            budget = limit > used ? limit - used : 0;
+        } else {
+            // leave a margin for the rest of the system and the allocator
+            budget = available_memory() / 4 * 3;
+            printf("Memory budget %zu [MiB] (3/4 of the available memory)\n",
+                   budget >> 20);
+        }
+        start = chrono::system_clock::now();
+        return sma_star(search_task, *heuristic, budget);
+    } else if (algorithm == "anytime") {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task, heuristic_name);
+        int num_plans = 0;
+        start = chrono::system_clock::now();
+        return anytime_search(
+            search_task, *heuristic, time_limit, [&](const vector<int>& plan) {
+                num_plans++;
+                string path = plan_path + "." + to_string(num_plans);
+                write_solution(task, path, plan);
+                printf("Plan of length %d written to %s\n", (int)plan.size(),
+                       path.c_str());
+            });
+    } else if (algorithm == "hda") {
+        start = chrono::system_clock::now();
+        return hda_star(
+            search_task,
+            [&]() { return make_heuristic(task, heuristic_name); },
+            num_threads, open_list_type);
+    } else {
+        throw invalid_argument("given search algorithm is not supported");
+    }
+}
+
+/*
+Parse "portfolio" into entries that run on a view of the shared "task".
+Without a heuristic, the one of "-H" is used, and without a time slice the
+time limit of "-l". Intermediate plans of entry i are written to
+"<solution_file_path>.<i>.1", ... so that concurrent entries do not
+overwrite each other's files.
+*/
+vector<PortfolioEntry> make_portfolio(Task& task) {
+    vector<PortfolioEntry> entries;
+    stringstream entry_stream(portfolio);
+    string entry;
+    while (getline(entry_stream, entry, ',')) {
+        vector<string> fields;
+        stringstream field_stream(entry);
+        string field;
+        while (getline(field_stream, field, ':')) {
+            fields.push_back(field);
+        }
+        if (fields.empty() || fields.size() > 3) {
+            throw invalid_argument("invalid portfolio entry " + entry);
+        }
+        string algorithm = fields[0];
+        string heuristic_name = fields.size() > 1 ? fields[1] : heuristic_type;
+        PortfolioEntry portfolio_entry;
+        portfolio_entry.name = entry;
+        portfolio_entry.time_slice =
+            fields.size() > 2 ? stod(fields[2]) : time_limit;
+        string plan_path =
+            solution_file_path + "." + to_string(entries.size());
+        portfolio_entry.run = [&task, algorithm, heuristic_name,
+                               plan_path](BaseTask& search_task) {
+            chrono::system_clock::time_point start;
+            return run_search(task, search_task, algorithm, heuristic_name,
+                              start, plan_path);
+        };
+        entries.push_back(portfolio_entry);
+    }
+    return entries;
+}
+
 int main(int argc, char* argv[]) {
     parse_args(argc, argv);
 
@@ -80,36 +353,12 @@ int main(int argc, char* argv[]) {
     printf("Search start: %s \n", task.name.c_str());
     chrono::system_clock::time_point start, end;
     vector<int> solution;
-    if (search_algorithm == "bfs") {
+    if (!portfolio.empty()) {
         start = chrono::system_clock::now();
-        solution = breadth_first_search(task);
-    } else if (search_algorithm == "astar") {
-        if (heuristic_type == "blind") {
-            BlindHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "goalcount") {
-            GoalCountHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "landmark") {
-            LandmarkHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-
-        } else if (heuristic_type == "hadd") {
-            hAddHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "hmax") {
-            hMaxHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else {
-            throw invalid_argument("given heuristic type is not supported");
-        }
+        solution = portfolio_search(task, make_portfolio(task));
     } else {
-        throw invalid_argument("given search algorithm is not supported");
+        solution = run_search(task, task, search_algorithm, heuristic_type,
+                              start, solution_file_path);
     }
     end = chrono::system_clock::now();
     float elapsed =
@@ -117,11 +366,7 @@ int main(int argc, char* argv[]) {
     printf("Search time is complete %f [ms] \n", elapsed);
 
     printf("Length of solution is %d \n", (int)solution.size());
-    ofstream solution_file;
-    solution_file.open(solution_file_path, ios::out);
-    for (int op : solution) {
-        solution_file << task.action_id2name[op] << "\n";
-    }
+    write_solution(task, solution_file_path, solution);
 
     /*
     std::string validate_cmd = "validate " + domain_file_path + " " +
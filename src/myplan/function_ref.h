@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+    /*
+    A non-owning reference to a callable. Unlike std::function it never
+    allocates, so it can be passed through virtual functions on hot paths.
+    The referenced callable must outlive the FunctionRef.
+    */
+   public:
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<F>, FunctionRef>::value>>
+    FunctionRef(F&& f)
+        : object(const_cast<void*>(
+              static_cast<const void*>(std::addressof(f)))),
+          callback([](void* object, Args... args) -> R {
+              return (*static_cast<std::remove_reference_t<F>*>(object))(
+                  std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const {
+        return callback(object, std::forward<Args>(args)...);
+    }
+
+   private:
+    void* object;
+    R (*callback)(void*, Args...);
+};
@@ -187,8 +187,8 @@ inline flat_hash_set<std::string> _collect_facts(
 }
 
 // Helper function to get grounded string
-std::string _get_grounded_string(std::string name,
-                                 std::vector<std::string> args) {
+inline std::string _get_grounded_string(std::string name,
+                                        std::vector<std::string> args) {
     std::string args_string = "";
     if (!args.empty()) {
         args_string += " ";
@@ -199,8 +199,14 @@ std::string _get_grounded_string(std::string name,
     return "(" + name + args_string + ")";
 }
 
+// Helper function to get the predicate of a grounded string "(name args)"
+inline std::string _get_predicate_name(const std::string& fact) {
+    size_t end = fact.find_first_of(" )");
+    return fact.substr(1, end == std::string::npos ? end : end - 1);
+}
+
 // Helper function to ground atom
-std::string _ground_atom(
+inline std::string _ground_atom(
     const Predicate& atom,
     const std::unordered_map<std::string, std::string>& assignment) {
     std::vector<std::string> names;
@@ -549,21 +555,22 @@ inline Task ground(Problem& problem,
         operators = relevance_analysis(operators, goals);
     }
 
-    int i = 0;
+    // Facts get the ids [0, F) and atoms of the same predicate are adjacent.
+    // Operators are numbered by their index in [0, O).
+    std::vector<std::string> fact_names(facts.begin(), facts.end());
+    std::sort(fact_names.begin(), fact_names.end(),
+              [](const std::string& a, const std::string& b) {
+                  return std::make_pair(_get_predicate_name(a), a) <
+                         std::make_pair(_get_predicate_name(b), b);
+              });
     std::unordered_map<std::string, int> encoding_map;
-    std::unordered_map<int, std::string> reverse_encoding_map;
-    for (std::string s : facts) {
-        encoding_map.insert({s, i});
-        reverse_encoding_map.insert({i, s});
-        i++;
+    for (int i = 0; i < (int)fact_names.size(); i++) {
+        encoding_map.insert({fact_names[i], i});
     }
 
-    std::unordered_map<int, std::string> action_id2name;
+    std::vector<std::string> action_id2name;
     for (Operator& op : operators) {
-        encoding_map.insert({op.name, i});
-        reverse_encoding_map.insert({i, op.name});
-        action_id2name.insert({i, op.name});
-        i++;
+        action_id2name.push_back(op.name);
     }
 
     flat_hash_set<int> encoded_facts;
@@ -571,22 +578,27 @@ inline Task ground(Problem& problem,
     flat_hash_set<int> encoded_goals;
     std::vector<EncodedOperator> encoded_operators;
 
-    for (std::string s : facts) {
-        encoded_facts.emplace(encoding_map[s]);
+    for (int i = 0; i < (int)fact_names.size(); i++) {
+        encoded_facts.emplace(i);
     }
     for (std::string s : init) {
-        encoded_init.emplace(encoding_map[s]);
+        // statics kept in the initial state are not part of the task
+        if (encoding_map.count(s) > 0) {
+            encoded_init.emplace(encoding_map[s]);
+        }
     }
     for (std::string s : goals) {
         encoded_goals.emplace(encoding_map[s]);
     }
-    for (Operator& op : operators) {
-        encoded_operators.push_back(EncodedOperator(op, encoding_map));
+    for (int i = 0; i < (int)operators.size(); i++) {
+        encoded_operators.push_back(
+            EncodedOperator(operators[i], i, encoding_map));
     }
 
     Task task(problem.name, encoded_facts, encoded_init, encoded_goals,
               encoded_operators);
     task.encoding_map = encoding_map;
+    task.reverse_encoding_map = fact_names;
     task.action_id2name = action_id2name;
     return task;
 }
@@ -1,18 +1,45 @@
 #pragma once
 
+#include <limits>
+
 #include "../search/searchspace.h"
 #include "../task.h"
 
+// The heuristic value of states from which the goal is unreachable
+const float FLOAT_INF = std::numeric_limits<float>::max();
+
 struct Heuristic {
-    virtual float calculate_h(int this_id, std::vector<SearchNode> &nodes) = 0;
+    virtual float calculate_h(int this_id, SearchSpace &space) = 0;
+    // True if all heuristic values are integers (or FLOAT_INF)
+    virtual bool integer_valued() { return true; }
+    /*
+    True if h(s) <= cost(o) + h(s') for every operator o leading from s to
+    s', so that the f values of A* never decrease along a path.
+    */
+    virtual bool consistent() { return false; }
+
+    // Length of the per-node payload (SearchNode::unreached) in words
+    virtual int node_payload_words() { return 0; }
+
+    virtual bool provides_preferred_operators() { return false; }
+    /*
+    Append the operators (by name id) that look most promising in the
+    state of node "this_id" to "preferred". Must be called right after
+    calculate_h(this_id, space).
+    */
+    virtual void get_preferred_operators(
+        [[maybe_unused]] int this_id, [[maybe_unused]] SearchSpace &space,
+        [[maybe_unused]] std::vector<int> &preferred) {}
 };
 
 struct BlindHeuristic : Heuristic {
-    Task task;
-    BlindHeuristic(Task &task_) { task = task_; }
+    Task &task;
+    BlindHeuristic(Task &task_) : task(task_) {}
 
-    float calculate_h(int this_id, std::vector<SearchNode> &nodes) {
-        if (task.goal_reached(nodes[this_id].state)) {
+    bool consistent() { return true; }
+
+    float calculate_h(int this_id, SearchSpace &space) {
+        if (task.goal_reached(space.state(this_id))) {
             return 1.0;
         } else {
             return 0.0;
@@ -21,16 +48,12 @@ struct BlindHeuristic : Heuristic {
 };
 
 struct GoalCountHeuristic : Heuristic {
-    Task task;
-    GoalCountHeuristic(Task &task_) { task = task_; }
-
-    float calculate_h(int this_id, std::vector<SearchNode> &nodes) {
-        int cnt_unsatisfied_cond = 0;
-        for (int g : task.goals) {
-            if (nodes[this_id].state.find(g) == nodes[this_id].state.end()) {
-                cnt_unsatisfied_cond++;
-            }
-        }
+    Task &task;
+    GoalCountHeuristic(Task &task_) : task(task_) {}
+
+    float calculate_h(int this_id, SearchSpace &space) {
+        int cnt_unsatisfied_cond =
+            task.goals.count_missing_in(space.state(this_id));
         return (float)cnt_unsatisfied_cond;
     }
 };
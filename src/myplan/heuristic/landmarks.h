@@ -5,8 +5,6 @@
 #include "base.h"
 #include "limits"
 
-const float FLOAT_INF = std::numeric_limits<float>::max();
-
 template <typename T>
 bool is_subset(const flat_hash_set<T>& set1, const flat_hash_set<T>& set2) {
     for (const T& elem : set1) {
@@ -17,15 +15,16 @@ bool is_subset(const flat_hash_set<T>& set1, const flat_hash_set<T>& set2) {
     return true;
 }
 
-Task _get_relaxed_task(Task task) {
+Task _get_relaxed_task(const Task& task) {
     Task relaxed_task = task;
     for (EncodedOperator& op : relaxed_task.operators) {
         op.del_effects = {};
     }
+    relaxed_task.initialize_operator_table();
     return relaxed_task;
 }
 
-flat_hash_set<int> get_landmarks(Task& task_) {
+flat_hash_set<int> get_landmarks(const Task& task_) {
     Task task = _get_relaxed_task(task_);
     flat_hash_set<int> landmarks(task.goals.begin(), task.goals.end());
     flat_hash_set<int> possible_landmarks(task.facts.begin(), task.facts.end());
@@ -36,31 +35,33 @@ flat_hash_set<int> get_landmarks(Task& task_) {
     }
 
     for (int fact : possible_landmarks) {
-        flat_hash_set<int> current_state(task.initial_state.begin(),
-                                         task.initial_state.end());
-        bool goal_reached = is_subset(task.goals, current_state);
+        State current_state = task.initial_state;
+        bool goal_reached = task.goals.is_subset_of(current_state);
 
         while (!goal_reached) {
-            flat_hash_set<int> previous_state(current_state.begin(),
-                                              current_state.end());
-
-            for (EncodedOperator op : task.operators) {
-                if (op.applicable(current_state) &&
-                    (op.add_effects.find(fact) == op.add_effects.end())) {
-                    current_state = op.apply(current_state, 0).second;
-                    if (is_subset(task.goals, current_state)) {
+            State previous_state = current_state;
+
+            const OperatorTable& table = task.operator_table;
+            for (int op = 0; op < table.size(); op++) {
+                Span<int> add = table.add(op);
+                if (table.applicable(op, current_state) &&
+                    !std::binary_search(add.begin(), add.end(), fact)) {
+                    for (int f : add) {
+                        current_state.insert(f);
+                    }
+                    if (task.goals.is_subset_of(current_state)) {
                         break;
                     }
                 }
             }
 
             if ((previous_state == current_state) &&
-                !(is_subset(task.goals, current_state))) {
+                !(task.goals.is_subset_of(current_state))) {
                 landmarks.insert(fact);
                 break;
             }
 
-            goal_reached = is_subset(task.goals, current_state);
+            goal_reached = task.goals.is_subset_of(current_state);
         }
     }
 
@@ -68,20 +69,21 @@ flat_hash_set<int> get_landmarks(Task& task_) {
 }
 
 flat_hash_map<int, float> compute_landmark_costs(
-    Task& task, flat_hash_set<int>& landmarks) {
-    flat_hash_map<int, flat_hash_set<int>> op_to_lm;
-    for (EncodedOperator& op : task.operators) {
-        for (int landmark : landmarks) {
-            if (op.add_effects.find(landmark) != op.add_effects.end()) {
-                op_to_lm[op.name].emplace(landmark);
+    const Task& task, flat_hash_set<int>& landmarks) {
+    const OperatorTable& table = task.operator_table;
+    std::vector<std::vector<int>> op_to_lm(table.size());
+    for (int op = 0; op < table.size(); op++) {
+        for (int landmark : table.add(op)) {
+            if (landmarks.count(landmark) > 0) {
+                op_to_lm[op].emplace_back(landmark);
             }
         }
     }
 
     flat_hash_map<int, float> min_cost;
-    for (auto& item : op_to_lm) {
-        int landmarks_achieving = item.second.size();
-        for (int landmark : item.second) {
+    for (std::vector<int>& achieved : op_to_lm) {
+        int landmarks_achieving = achieved.size();
+        for (int landmark : achieved) {
             if (min_cost.find(landmark) == min_cost.end()) {
                 min_cost[landmark] = FLOAT_INF;
             }
@@ -94,43 +96,54 @@ flat_hash_map<int, float> compute_landmark_costs(
 }
 
 struct LandmarkHeuristic : Heuristic {
-    Task task;
+    const Task& task;
     flat_hash_set<int> landmarks;
-    flat_hash_map<int, float> costs;
-    LandmarkHeuristic(Task& task_) {
-        task = task_;
+    State landmarks_mask;
+    State unreached;
+    // indexed by fact id
+    std::vector<float> costs;
+    LandmarkHeuristic(const Task& task_) : task(task_) {
         landmarks = get_landmarks(task);
-        costs = compute_landmark_costs(task, landmarks);
+        costs.assign(task.num_facts, 0);
+        for (auto& item : compute_landmark_costs(task, landmarks)) {
+            costs[item.first] = item.second;
+        }
+        landmarks_mask = State(landmarks);
+        landmarks_mask.resize(task.num_facts);
     }
 
-    float calculate_h(int this_id, std::vector<SearchNode>& nodes) {
-        if (nodes[this_id].parent_id == -1) {
-            nodes[this_id].unreached = landmarks;
-            for (int s : task.initial_state) {
-                // if (nodes[this_id].unreached.count(s) > 0) {
-                nodes[this_id].unreached.erase(s);
-                //}
+    bool integer_valued() { return false; }
+
+    int node_payload_words() { return landmarks_mask.num_words(); }
+
+    float calculate_h(int this_id, SearchSpace& space) {
+        int num_words = landmarks_mask.num_words();
+        uint64_t* node_unreached =
+            space.arena.allocate_array<uint64_t>(num_words);
+        if (space[this_id].parent_id == -1) {
+            for (int i = 0; i < num_words; i++) {
+                node_unreached[i] = landmarks_mask.words[i] &
+                                    ~task.initial_state.view().word(i);
             }
         } else {
-            nodes[this_id].unreached =
-                nodes[nodes[this_id].parent_id].unreached;
-            // if (nodes[this_id].unreached.count(nodes[this_id].action) > 0) {
-            nodes[this_id].unreached.erase(nodes[this_id].action);
-            //}
-        }
-
-        flat_hash_set<int> unreached(nodes[this_id].unreached.begin(),
-                                     nodes[this_id].unreached.end());
-        for (int s : task.goals) {
-            if (unreached.count(s) == 0) {
-                unreached.emplace(s);
+            // the landmarks added by the action are reached now
+            const uint64_t* parent_unreached =
+                space[space[this_id].parent_id].unreached;
+            std::copy(parent_unreached, parent_unreached + num_words,
+                      node_unreached);
+            for (const EffectMask& e :
+                 task.operator_table.effect_masks(
+                     task.operator_table.index(space[this_id].action))) {
+                if (e.word < num_words) {
+                    node_unreached[e.word] &= ~e.add;
+                }
             }
         }
-        for (int s : nodes[this_id].state) {
-            // if (unreached.count(s) > 0) {
-            unreached.erase(s);
-            //}
-        }
+        space[this_id].unreached = node_unreached;
+
+        unreached.words.assign(node_unreached, node_unreached + num_words);
+        unreached.set_union(task.goals);
+        unreached.set_difference(space.state(this_id));
 
         float h = 0;
         for (int landmark : unreached) {
@@ -1,220 +1,563 @@
 #pragma once
 
-#include <queue>
-#include <set>
-#include <string>
-#include <tuple>
-#include <unordered_set>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
 
+#include "../operator_table.h"
+#include "../parallel_hashmap/phmap.h"
 #include "../search/searchspace.h"
 #include "../task.h"
 #include "base.h"
-#include "limits"
+
+// The distance of facts that are not reached by the relaxed exploration
+const int RELAXED_INF = INT_MAX;
 
 struct RelaxedOperator {
-    int name;
-    std::vector<int> preconditions;
-    std::vector<int> add_effects;
+    // the number of preconditions that have not been reached yet
+    int unreached;
+    // the sum (hAdd) or maximum (hMax) of the distances of the reached
+    // preconditions
     int cost;
-    int counter;
-
-    RelaxedOperator(int name, std::vector<int>& preconditions,
-                    std::vector<int>& add_effects)
-        : name(name),
-          preconditions(preconditions),
-          add_effects(add_effects),
-          cost(1),
-          counter(preconditions.size()) {}
+    // the cost of the operator itself
+    int own_cost;
 };
 
-struct RelaxedFact {
-    int name;
+struct _RelaxationHeuristic : Heuristic {
+    /*
+    Dijkstra exploration of the delete relaxation from the facts of a state.
+    The cost of an operator is its own cost plus the sum (hAdd) or the
+    maximum (hMax) of the distances of its preconditions, which is
+    accumulated as the preconditions are reached; the operator fires when
+    the last one is reached.
+
+    Everything lives in arrays indexed by fact or operator id that are
+    allocated once: the operators having a fact as precondition are stored
+    back to back (CSR style, like the OperatorTable), distances are
+    integers, and the priority queue is a bucket queue indexed by distance
+    whose buckets keep their capacity between calls. The exploration stops
+    as soon as the last goal is reached. The counters and costs of all
+    operators are kept next to each other and reset by copying a template.
+
+    With a cache of "cache_size" states, the distances and supporters of
+    the last evaluated states are kept (keyed by state hash, replaced in
+    first-in first-out order), and a node whose parent is cached is
+    evaluated incrementally from the parent's distances (see repair).
+    Cached explorations do not stop at the goals, so that they are fixed
+    points for all facts. The distances equal those of a full exploration,
+    but ties between supporters (and hence relaxed plans) may be broken
+    differently.
+
+    The operator table is read from the task, which must outlive the
+    heuristic.
+    */
+    const OperatorTable& operator_table;
+    int num_facts;
+    bool use_max;
+    // the operators with precondition f are
+    // precondition_of[precondition_of_offsets[f]:precondition_of_offsets[f+1]]
+    std::vector<int> precondition_of_offsets;
     std::vector<int> precondition_of;
-    bool expanded;
-    float distance;
-
-    RelaxedFact() {}
-    RelaxedFact(int name)
-        : name(name),
-          expanded(false),
-          distance(std::numeric_limits<float>::max()) {}
-};
+    std::vector<int> no_preconditions;
+    std::vector<int> goal_facts;
+    std::vector<bool> is_goal;
 
-struct _RelaxationHeuristic : Heuristic {
-    flat_hash_map<int, RelaxedFact> facts;
+    // the operators before the exploration
+    std::vector<RelaxedOperator> initial_operators;
+
+    // per call: the distance of each fact and the state of each operator
+    std::vector<int> distance;
     std::vector<RelaxedOperator> operators;
-    flat_hash_set<int> init;
-    flat_hash_set<int> goals;
-    int tie_breaker;
-    RelaxedFact start_state;
+    // the operator that reached each fact with its distance, -1 if none
+    std::vector<int> supporter;
+    std::vector<std::vector<int>> buckets;
+    // the largest distance pushed in the current call
+    int top_bucket = 0;
 
-    _RelaxationHeuristic(Task& task)
-        : tie_breaker(0),
-          goals(task.goals),
-          init(task.initial_state),
-          start_state(RelaxedFact(-1)) {
-        facts.emplace(-1, start_state);
-        for (int fact : task.facts) {
-            facts.emplace(fact, RelaxedFact(fact));
-        }
+    // the operators adding fact f are
+    // achievers[achiever_offsets[f]:achiever_offsets[f+1]]
+    std::vector<int> achiever_offsets;
+    std::vector<int> achievers;
+    int cache_size;
+    // repair only if at most this fraction of the facts is affected
+    float max_affected_fraction = 0.25;
+    // the distances and supporters of cached state i are stored at
+    // cache_distance[i * num_facts] and cache_supporter[i * num_facts],
+    // its packed state at cache_words[i * num_words]
+    std::vector<int> cache_distance;
+    std::vector<int> cache_supporter;
+    std::vector<state_hash_t> cache_hash;
+    int num_words;
+    std::vector<uint64_t> cache_words;
+    phmap::flat_hash_map<state_hash_t, int> cache_slot;
+    int next_slot = 0;
+    std::vector<bool> affected;
+    std::vector<int> affected_facts;
+    std::vector<bool> queued;
+    std::vector<int> queued_facts;
+    long incremental_evaluations = 0;
+    long full_evaluations = 0;
 
-        for (EncodedOperator& op : task.operators) {
-            operators.emplace_back(RelaxedOperator(
-                op.name, op.preconditions_vec, op.add_effects_vec));
+    // the operators of the last relaxed plan (see extract_relaxed_plan)
+    std::vector<int> relaxed_plan;
+    // true if "relaxed_plan" belongs to the state of the last calculate_h
+    bool relaxed_plan_extracted = false;
+    std::vector<bool> fact_marked;
+    std::vector<bool> operator_marked;
+    std::vector<int> marked_facts;
+    std::vector<int> open_facts;
 
-            for (int var : op.preconditions_vec) {
-                facts[var].precondition_of.emplace_back(operators.size() - 1);
+    /*
+    @param cache_size: The number of states whose distances are kept for
+    incremental evaluation (0 disables it)
+    */
+    _RelaxationHeuristic(const Task& task, bool use_max, int cache_size = 0)
+        : operator_table(task.operator_table),
+          num_facts(task.num_facts),
+          use_max(use_max),
+          cache_size(cache_size),
+          num_words(num_words_for(task.num_facts)) {
+        int num_operators = operator_table.size();
+        precondition_of_offsets.assign(num_facts + 1, 0);
+        for (int op = 0; op < num_operators; op++) {
+            for (int f : operator_table.pre(op)) {
+                precondition_of_offsets[f + 1]++;
+            }
+            if (operator_table.pre(op).empty()) {
+                no_preconditions.push_back(op);
+            }
+        }
+        for (int f = 0; f < num_facts; f++) {
+            precondition_of_offsets[f + 1] += precondition_of_offsets[f];
+        }
+        precondition_of.resize(precondition_of_offsets[num_facts]);
+        std::vector<int> next(precondition_of_offsets.begin(),
+                              precondition_of_offsets.end() - 1);
+        for (int op = 0; op < num_operators; op++) {
+            for (int f : operator_table.pre(op)) {
+                precondition_of[next[f]++] = op;
             }
+        }
+
+        is_goal.assign(num_facts, false);
+        for (int f : task.goals) {
+            goal_facts.push_back(f);
+            is_goal[f] = true;
+        }
+        distance.assign(num_facts, RELAXED_INF);
+        supporter.assign(num_facts, -1);
+        for (int op = 0; op < num_operators; op++) {
+            initial_operators.push_back(RelaxedOperator{
+                operator_table.pre(op).size(), 0, operator_table.cost(op)});
+        }
+        operators = initial_operators;
+        fact_marked.assign(num_facts, false);
+        operator_marked.assign(num_operators, false);
 
-            if (op.preconditions_vec.size() == 0) {
-                start_state.precondition_of.emplace_back(operators.size() - 1);
+        if (cache_size > 0) {
+            achiever_offsets.assign(num_facts + 1, 0);
+            for (int op = 0; op < num_operators; op++) {
+                for (int f : operator_table.add(op)) {
+                    achiever_offsets[f + 1]++;
+                }
             }
+            for (int f = 0; f < num_facts; f++) {
+                achiever_offsets[f + 1] += achiever_offsets[f];
+            }
+            achievers.resize(achiever_offsets[num_facts]);
+            next.assign(achiever_offsets.begin(), achiever_offsets.end() - 1);
+            for (int op = 0; op < num_operators; op++) {
+                for (int f : operator_table.add(op)) {
+                    achievers[next[f]++] = op;
+                }
+            }
+            cache_distance.resize((size_t)cache_size * num_facts);
+            cache_supporter.resize((size_t)cache_size * num_facts);
+            cache_hash.resize(cache_size);
+            cache_words.resize((size_t)cache_size * num_words);
+            affected.assign(num_facts, false);
+            queued.assign(num_facts, false);
         }
     }
 
-    virtual float eval(std::vector<float>& distances) = 0;
-
-    float calculate_h(int this_id, std::vector<SearchNode>& nodes) {
-        init_distance(nodes[this_id].state);
+    float calculate_h(int this_id, SearchSpace& space) {
+        relaxed_plan_extracted = false;
+        StateView state = space.state(this_id);
+        if (cache_size == 0) {
+            explore(state);
+        } else {
+            int parent_id = space[this_id].parent_id;
+            auto it = parent_id == -1 ? cache_slot.end()
+                                      : cache_slot.find(space.hash(parent_id));
+            // the hashes of different states may collide
+            if (it != cache_slot.end() &&
+                holds(it->second, space.state(parent_id)) &&
+                repair(space.state(parent_id), state, it->second)) {
+                incremental_evaluations++;
+            } else {
+                explore(state);
+                full_evaluations++;
+            }
+            store(state, space.hash(this_id));
+        }
+        int h = 0;
+        for (int f : goal_facts) {
+            if (distance[f] == RELAXED_INF) {
+                return FLOAT_INF;
+            }
+            h = use_max ? std::max(h, distance[f]) : h + distance[f];
+        }
+        return (float)h;
+    }
 
-        std::priority_queue<tuple<float, int, int>> queue;
-        queue.push({0, -tie_breaker, start_state.name});
-        tie_breaker++;
+    void push(int d, int f) {
+        if (d >= (int)buckets.size()) {
+            buckets.resize(d + 1);
+        }
+        buckets[d].push_back(f);
+        top_bucket = std::max(top_bucket, d);
+    }
 
-        for (int fact : nodes[this_id].state) {
-            queue.push({-facts[fact].distance, -tie_breaker, facts[fact].name});
-            tie_breaker++;
+    // Lower the distance of fact "f" to "d" if that is shorter
+    void reach(int f, int d, int op) {
+        if (d < distance[f]) {
+            distance[f] = d;
+            supporter[f] = op;
+            push(d, f);
         }
+    }
 
-        dijkstra(queue);
-        float h = calc_goal_h();
-        return h;
+    // The preconditions of "op" are reached: lower the distances of its
+    // add effects
+    void fire(int op) {
+        int d = operators[op].cost + operators[op].own_cost;
+        for (int f : operator_table.add(op)) {
+            reach(f, d, op);
+        }
     }
 
-    void reset_fact(RelaxedFact& fact, const flat_hash_set<int>& state) {
-        fact.expanded = false;
-        if (state.find(fact.name) != state.end()) {
-            fact.distance = 0;
+    void explore(const StateView& state) {
+        if (use_max) {
+            explore<true>(state);
         } else {
-            fact.distance = std::numeric_limits<float>::max();
+            explore<false>(state);
         }
     }
 
-    void init_distance(const flat_hash_set<int>& state) {
-        reset_fact(start_state, state);
+    template <bool max_cost>
+    void explore(const StateView& state) {
+        std::fill(distance.begin(), distance.end(), RELAXED_INF);
+        std::fill(supporter.begin(), supporter.end(), -1);
+        std::copy(initial_operators.begin(), initial_operators.end(),
+                  operators.begin());
+        top_bucket = 0;
 
-        for (auto& item : facts) {
-            reset_fact(item.second, state);
+        for (int f : state) {
+            reach(f, 0, -1);
+        }
+        for (int op : no_preconditions) {
+            fire(op);
         }
 
-        for (RelaxedOperator& op : operators) {
-            op.counter = op.preconditions.size();
+        // cached explorations reach all facts
+        int goals_left = cache_size > 0 ? INT_MAX : (int)goal_facts.size();
+        for (int d = 0; d <= top_bucket && d < (int)buckets.size(); d++) {
+            // facts are appended to the current bucket by zero-cost
+            // operators, so it is not iterated over directly
+            while (goals_left > 0 && !buckets[d].empty()) {
+                int f = buckets[d].back();
+                buckets[d].pop_back();
+                if (distance[f] != d) {
+                    continue;  // reached with a shorter distance before
+                }
+                if (is_goal[f]) {
+                    goals_left--;
+                }
+                for (int i = precondition_of_offsets[f];
+                     i < precondition_of_offsets[f + 1]; i++) {
+                    RelaxedOperator& op = operators[precondition_of[i]];
+                    op.cost = max_cost ? std::max(op.cost, d) : op.cost + d;
+                    if (--op.unreached == 0) {
+                        fire(precondition_of[i]);
+                    }
+                }
+            }
+            buckets[d].clear();
         }
     }
 
-    float get_cost(RelaxedOperator& op, RelaxedFact& pre) {
-        float cost = 0;
-        if (op.preconditions.size() != 0) {
-            std::vector<float> tmp_distances;
-            tmp_distances.reserve(op.preconditions.size());
-            for (int pre : op.preconditions) {
-                tmp_distances.emplace_back(facts[pre].distance);
+    // The cost of reaching the add effects of "op" with the current
+    // distances of its preconditions
+    int operator_cost(int op) const {
+        int cost = 0;
+        for (int f : operator_table.pre(op)) {
+            if (distance[f] == RELAXED_INF) {
+                return RELAXED_INF;
             }
-            cost = eval(tmp_distances);
-        } else {
-            cost = 0;
+            cost = use_max ? std::max(cost, distance[f]) : cost + distance[f];
         }
-        return cost + op.cost;
+        return cost + operators[op].own_cost;
     }
 
-    float calc_goal_h() {
-        if (goals.size() != 0) {
-            std::vector<float> tmp_distances;
-            tmp_distances.reserve(goals.size());
-            for (int fact : goals) {
-                tmp_distances.emplace_back(facts[fact].distance);
+    // True if cache slot "slot" holds the state "state"
+    bool holds(int slot, const StateView& state) const {
+        const uint64_t* words = cache_words.data() + (size_t)slot * num_words;
+        for (int i = 0; i < num_words; i++) {
+            if (words[i] != state.word(i)) {
+                return false;
             }
-            return eval(tmp_distances);
+        }
+        return true;
+    }
+
+    // Keep the distances and supporters of the last call for the state
+    // "state" with hash "hash". A colliding state is replaced.
+    void store(const StateView& state, state_hash_t hash) {
+        int slot;
+        auto it = cache_slot.find(hash);
+        if (it != cache_slot.end()) {
+            slot = it->second;
         } else {
-            return 0.0;
-        }
-    }
-
-    bool finished(flat_hash_set<int>& achived_goals,
-                  std::priority_queue<tuple<float, int, int>>& queue) {
-        // bool flag = true;
-        // for (int i : goals) {
-        //    if (achived_goals.find(i) != achived_goals.end()) {
-        //        flag = false;
-        //        break;
-        //    }
-        // }
-        return (achived_goals == goals) || (queue.empty());
-    }
-
-    void dijkstra(std::priority_queue<tuple<float, int, int>>& queue) {
-        flat_hash_set<int> achived_goals;
-        tuple<float, int, int> front;
-        float _dist, tmp_dist;
-        int _tie, fact_idx, fact_id, num_precondition_of;
-        while (!finished(achived_goals, queue)) {
-            front = queue.top();
-            queue.pop();
-            _dist = -1 * get<0>(front);
-            _tie = -1 * get<1>(front);
-            fact_id = get<2>(front);
-
-            if (goals.find(facts[fact_id].name) != goals.end()) {
-                achived_goals.emplace(facts[fact_id].name);
-            }
-            if (!facts[fact_id].expanded) {
-                num_precondition_of = facts[fact_id].precondition_of.size();
-                for (int i = 0; i < num_precondition_of; i++) {
-                    operators[facts[fact_id].precondition_of[i]].counter--;
-                    if (operators[facts[fact_id].precondition_of[i]].counter <=
-                        0) {
-                        for (int n :
-                             operators[facts[fact_id].precondition_of[i]]
-                                 .add_effects) {
-                            tmp_dist = get_cost(
-                                operators[facts[fact_id].precondition_of[i]],
-                                facts[fact_id]);
-                            if (tmp_dist < facts[n].distance) {
-                                facts[n].distance = tmp_dist;
-                                queue.push({-tmp_dist, -tie_breaker, n});
-                                tie_breaker++;
-                            }
+            slot = next_slot;
+            next_slot = (next_slot + 1) % cache_size;
+            if ((int)cache_slot.size() == cache_size) {
+                cache_slot.erase(cache_hash[slot]);
+            }
+            cache_hash[slot] = hash;
+            cache_slot[hash] = slot;
+        }
+        uint64_t* words = cache_words.data() + (size_t)slot * num_words;
+        for (int i = 0; i < num_words; i++) {
+            words[i] = state.word(i);
+        }
+        std::copy(distance.begin(), distance.end(),
+                  cache_distance.begin() + (size_t)slot * num_facts);
+        std::copy(supporter.begin(), supporter.end(),
+                  cache_supporter.begin() + (size_t)slot * num_facts);
+    }
+
+    // Queue the facts supported by an operator with the precondition "g"
+    // as candidates of being affected
+    void queue_dependents(int g) {
+        for (int i = precondition_of_offsets[g];
+             i < precondition_of_offsets[g + 1]; i++) {
+            int op = precondition_of[i];
+            for (int f : operator_table.add(op)) {
+                if (supporter[f] == op && !queued[f]) {
+                    queued[f] = true;
+                    queued_facts.push_back(f);
+                    push(distance[f], f);
+                }
+            }
+        }
+    }
+
+    // Make an operator whose preconditions are final and cheaper than fact
+    // "f", and that reaches "f" with its current distance, the supporter of
+    // "f" @return false if there is none
+    bool find_other_supporter(int f) {
+        int d = distance[f];
+        for (int i = achiever_offsets[f]; i < achiever_offsets[f + 1]; i++) {
+            int op = achievers[i];
+            bool valid = op != supporter[f];
+            for (int p : operator_table.pre(op)) {
+                if (!valid) {
+                    break;
+                }
+                valid = !affected[p] && distance[p] < d;
+            }
+            if (valid && operator_cost(op) == d) {
+                supporter[f] = op;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+    Compute the distances for "state" from the cached ones of "parent"
+    (Ramalingam and Reps 1996). The facts deleted from the parent are
+    affected, i.e. may get more expensive, and so is every fact whose
+    supporter has an affected precondition unless another operator reaches
+    it with the same distance from unaffected facts; these candidates are
+    decided in the order of distance. The affected facts are then reset and
+    reached again from their achievers, and the facts added to the parent
+    get cheaper. The changes are propagated in the order of distance,
+    recomputing the cost of the operators whose preconditions changed; all
+    other distances stay valid.
+    @return false if too many facts are affected
+    */
+    bool repair(const StateView& parent, const StateView& state, int slot) {
+        std::copy(cache_distance.begin() + (size_t)slot * num_facts,
+                  cache_distance.begin() + (size_t)(slot + 1) * num_facts,
+                  distance.begin());
+        std::copy(cache_supporter.begin() + (size_t)slot * num_facts,
+                  cache_supporter.begin() + (size_t)(slot + 1) * num_facts,
+                  supporter.begin());
+        int max_affected = (int)(max_affected_fraction * num_facts);
+        affected_facts.clear();
+        queued_facts.clear();
+        top_bucket = 0;
+        for (int f : parent) {
+            if (!state.contains(f)) {
+                affected[f] = true;
+                affected_facts.push_back(f);
+                queue_dependents(f);
+            }
+        }
+        for (int d = 0; d <= top_bucket && d < (int)buckets.size(); d++) {
+            while (!buckets[d].empty() &&
+                   (int)affected_facts.size() <= max_affected) {
+                int f = buckets[d].back();
+                buckets[d].pop_back();
+                if (!affected[f] && !find_other_supporter(f)) {
+                    affected[f] = true;
+                    affected_facts.push_back(f);
+                    queue_dependents(f);
+                }
+            }
+            buckets[d].clear();
+        }
+        for (int f : queued_facts) {
+            queued[f] = false;
+        }
+        if ((int)affected_facts.size() > max_affected) {
+            for (int f : affected_facts) {
+                affected[f] = false;
+            }
+            return false;
+        }
+
+        for (int f : affected_facts) {
+            distance[f] = RELAXED_INF;
+            supporter[f] = -1;
+        }
+        top_bucket = 0;
+        for (int f : state) {
+            if (!parent.contains(f)) {
+                reach(f, 0, -1);
+            }
+        }
+        for (int f : affected_facts) {
+            affected[f] = false;
+            for (int i = achiever_offsets[f]; i < achiever_offsets[f + 1];
+                 i++) {
+                int op = achievers[i];
+                reach(f, operator_cost(op), op);
+            }
+        }
+
+        for (int d = 0; d <= top_bucket && d < (int)buckets.size(); d++) {
+            while (!buckets[d].empty()) {
+                int f = buckets[d].back();
+                buckets[d].pop_back();
+                if (distance[f] != d) {
+                    continue;
+                }
+                for (int i = precondition_of_offsets[f];
+                     i < precondition_of_offsets[f + 1]; i++) {
+                    int op = precondition_of[i];
+                    int cost = operator_cost(op);
+                    if (cost != RELAXED_INF) {
+                        for (int g : operator_table.add(op)) {
+                            reach(g, cost, op);
                         }
                     }
                 }
-                facts[fact_id].expanded = true;
             }
         }
+        return true;
     }
-};
 
-struct hAddHeuristic : _RelaxationHeuristic {
-    using _RelaxationHeuristic::_RelaxationHeuristic;
+    /*
+    Collect the operators of a relaxed plan for the state of the last call
+    of calculate_h in "relaxed_plan": starting from the goals, the best
+    supporter of every fact that is not true in the state is added together
+    with the supporters of its preconditions.
+    */
+    void extract_relaxed_plan() {
+        if (relaxed_plan_extracted) {
+            return;
+        }
+        relaxed_plan_extracted = true;
+        relaxed_plan.clear();
+        open_facts.assign(goal_facts.begin(), goal_facts.end());
+        while (!open_facts.empty()) {
+            int f = open_facts.back();
+            open_facts.pop_back();
+            if (fact_marked[f]) {
+                continue;
+            }
+            fact_marked[f] = true;
+            marked_facts.push_back(f);
+            int op = supporter[f];
+            if (op == -1 || operator_marked[op]) {
+                continue;
+            }
+            operator_marked[op] = true;
+            relaxed_plan.push_back(op);
+            for (int pre : operator_table.pre(op)) {
+                open_facts.push_back(pre);
+            }
+        }
+        for (int f : marked_facts) {
+            fact_marked[f] = false;
+        }
+        marked_facts.clear();
+        for (int op : relaxed_plan) {
+            operator_marked[op] = false;
+        }
+    }
+
+    bool provides_preferred_operators() { return true; }
 
-    float eval(std::vector<float>& distances) {
-        float res = 0;
-        for (float d : distances) {
-            res += d;
+    // Helpful actions: the operators of the relaxed plan applicable in the
+    // state
+    void get_preferred_operators(int this_id, SearchSpace& space,
+                                 std::vector<int>& preferred) {
+        extract_relaxed_plan();
+        StateView state = space.state(this_id);
+        for (int op : relaxed_plan) {
+            Span<int> pre = operator_table.pre(op);
+            if (std::all_of(pre.begin(), pre.end(),
+                            [&](int f) { return state.contains(f); })) {
+                preferred.push_back(operator_table.name(op));
+            }
         }
-        return res;
     }
 };
 
+struct hAddHeuristic : _RelaxationHeuristic {
+    hAddHeuristic(const Task& task, int cache_size = 0)
+        : _RelaxationHeuristic(task, false, cache_size) {}
+};
+
 struct hMaxHeuristic : _RelaxationHeuristic {
-    using _RelaxationHeuristic::_RelaxationHeuristic;
+    hMaxHeuristic(const Task& task, int cache_size = 0)
+        : _RelaxationHeuristic(task, true, cache_size) {}
 
-    float eval(std::vector<float>& distances) {
-        float res = 0;
-        for (float d : distances) {
-            if (d > res) {
-                res = d;
-            }
+    bool consistent() { return true; }
+};
+
+struct hFFHeuristic : hAddHeuristic {
+    /*
+    The FF heuristic (Hoffmann and Nebel 2001): the cost of a relaxed plan
+    extracted from the best supporters of the hAdd exploration. Its
+    preferred operators are the helpful actions of that plan.
+    */
+    using hAddHeuristic::hAddHeuristic;
+
+    float calculate_h(int this_id, SearchSpace& space) {
+        float h_add = hAddHeuristic::calculate_h(this_id, space);
+        if (h_add >= FLOAT_INF) {
+            return FLOAT_INF;
+        }
+        extract_relaxed_plan();
+        float h = 0;
+        for (int op : relaxed_plan) {
+            h += operator_table.cost(op);
         }
-        return res;
+        return h;
     }
 };
@@ -0,0 +1,172 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "state.h"
+#include "zobrist.h"
+
+// The effects of an operator on one word of a packed state
+struct EffectMask {
+    int word;
+    uint64_t del;
+    uint64_t add;
+};
+
+template <typename T>
+struct Span {
+    /*
+    A read-only view of a contiguous range.
+    */
+    const T* first;
+    const T* last;
+
+    Span() : first(nullptr), last(nullptr) {}
+    Span(const T* first, const T* last) : first(first), last(last) {}
+    Span(const std::vector<T>& v) : first(v.data()), last(v.data() + v.size()) {}
+
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    int size() const { return (int)(last - first); }
+    bool empty() const { return first == last; }
+    const T& operator[](int i) const { return first[i]; }
+};
+
+class OperatorTable {
+    /*
+    A read-only table of the operators of a task in structure-of-arrays
+    form. The preconditions, add effects and delete effects of all
+    operators are stored back to back in one array each (CSR style):
+    operator o owns pre_facts[pre_offsets[o]:pre_offsets[o+1]], and so on.
+    The facts of every list are sorted. Word masks for testing and applying
+    the operators on packed states are stored the same way.
+    */
+   public:
+    std::vector<int> pre_offsets;
+    std::vector<int> pre_facts;
+    std::vector<int> add_offsets;
+    std::vector<int> add_facts;
+    std::vector<int> del_offsets;
+    std::vector<int> del_facts;
+    std::vector<int> pre_mask_offsets;
+    std::vector<WordMask> pre_masks;
+    std::vector<int> effect_offsets;
+    std::vector<EffectMask> effects;
+    std::vector<int> costs;
+    std::vector<int> names;
+    // the index of the operator with a given name id, or -1
+    std::vector<int> name_to_index;
+
+    OperatorTable() { clear(); }
+
+    void clear() {
+        for (std::vector<int>* offsets : {&pre_offsets, &add_offsets,
+                                          &del_offsets, &pre_mask_offsets,
+                                          &effect_offsets}) {
+            offsets->assign(1, 0);
+        }
+        pre_facts.clear();
+        add_facts.clear();
+        del_facts.clear();
+        pre_masks.clear();
+        effects.clear();
+        costs.clear();
+        names.clear();
+        name_to_index.clear();
+    }
+
+    /*
+    Append an operator.
+    @return The index of the operator in the table
+    */
+    int add_operator(int name, std::vector<int> preconditions,
+                     std::vector<int> add_effects, std::vector<int> del_effects,
+                     int cost = 1) {
+        append_list(preconditions, pre_offsets, pre_facts);
+        append_list(add_effects, add_offsets, add_facts);
+        append_list(del_effects, del_offsets, del_facts);
+
+        std::vector<WordMask> pre_mask = make_word_masks(preconditions);
+        pre_masks.insert(pre_masks.end(), pre_mask.begin(), pre_mask.end());
+        pre_mask_offsets.push_back((int)pre_masks.size());
+
+        // merge the add and delete masks word by word
+        std::vector<WordMask> add_mask = make_word_masks(add_effects);
+        std::vector<WordMask> del_mask = make_word_masks(del_effects);
+        size_t d = 0, a = 0;
+        while (d < del_mask.size() || a < add_mask.size()) {
+            int word =
+                std::min(d < del_mask.size() ? del_mask[d].word : INT_MAX,
+                         a < add_mask.size() ? add_mask[a].word : INT_MAX);
+            EffectMask e = {word, 0, 0};
+            if (d < del_mask.size() && del_mask[d].word == word) {
+                e.del = del_mask[d++].bits;
+            }
+            if (a < add_mask.size() && add_mask[a].word == word) {
+                e.add = add_mask[a++].bits;
+            }
+            effects.push_back(e);
+        }
+        effect_offsets.push_back((int)effects.size());
+
+        costs.push_back(cost);
+        names.push_back(name);
+        if (name >= (int)name_to_index.size()) {
+            name_to_index.resize(name + 1, -1);
+        }
+        name_to_index[name] = (int)names.size() - 1;
+        return (int)names.size() - 1;
+    }
+
+    int size() const { return (int)names.size(); }
+
+    Span<int> pre(int op) const { return range(pre_offsets, pre_facts, op); }
+    Span<int> add(int op) const { return range(add_offsets, add_facts, op); }
+    Span<int> del(int op) const { return range(del_offsets, del_facts, op); }
+    Span<EffectMask> effect_masks(int op) const {
+        return range(effect_offsets, effects, op);
+    }
+    int cost(int op) const { return costs[op]; }
+    int name(int op) const { return names[op]; }
+    int index(int name) const { return name_to_index[name]; }
+
+    bool applicable(int op, const StateView& state) const {
+        for (const WordMask& m : range(pre_mask_offsets, pre_masks, op)) {
+            if ((state.word(m.word) & m.bits) != m.bits) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The hash of the state reached by applying "op" in "state"
+    state_hash_t successor_hash(int op, const StateView& state,
+                                state_hash_t hash_val,
+                                const ZobristTable& zobrist) const {
+        for (const EffectMask& e : effect_masks(op)) {
+            uint64_t old_word = state.word(e.word);
+            uint64_t changed = old_word ^ ((old_word & ~e.del) | e.add);
+            for (; changed; changed &= changed - 1) {
+                hash_val ^= zobrist.key(e.word * BITS_PER_WORD +
+                                        __builtin_ctzll(changed));
+            }
+        }
+        return hash_val;
+    }
+
+   private:
+    static void append_list(std::vector<int>& facts, std::vector<int>& offsets,
+                            std::vector<int>& data) {
+        std::sort(facts.begin(), facts.end());
+        facts.erase(std::unique(facts.begin(), facts.end()), facts.end());
+        data.insert(data.end(), facts.begin(), facts.end());
+        offsets.push_back((int)data.size());
+    }
+
+    template <typename T>
+    static Span<T> range(const std::vector<int>& offsets,
+                         const std::vector<T>& data, int op) {
+        return Span<T>(data.data() + offsets[op], data.data() + offsets[op + 1]);
+    }
+};
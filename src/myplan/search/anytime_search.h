@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "best_first_search.h"
+#include "open_list.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+class AnytimeSearch {
+    /*
+    Restarting weighted A* (Richter, Thayer and Ruml 2010): weighted A* is
+    run with decreasing weights, each run restarting from the initial state
+    and ending with the first plan cheaper than the incumbent. Nodes with
+    g + h >= the cost of the incumbent are pruned, so a run that empties its
+    open list proves the incumbent optimal (for admissible heuristics) and
+    ends the search, as does a plan found with weight 1.
+
+    All runs share one SearchSpace with a single node per state (node id ==
+    state id) holding its cheapest known path, so the heuristic of a state
+    is evaluated only once; path dependent heuristics keep the value and
+    payload of the first path. A state reached for the first time in a run
+    is queued with its cheapest path of any earlier run.
+    */
+   public:
+    SearchStatistics statistics;
+    // the weights of the runs in order
+    std::vector<float> weights = {5, 3, 2, 1.5, 1};
+
+    /*
+    @param time_limit: In seconds, no limit if <= 0
+    @param on_plan: Called with every plan cheaper than the ones before
+    */
+    AnytimeSearch(BaseTask& planning_task, Heuristic& heuristic,
+                  double time_limit = 0,
+                  std::function<void(const std::vector<int>&)> on_plan =
+                      [](const std::vector<int>&) {})
+        : planning_task(planning_task),
+          heuristic(heuristic),
+          time_limit(time_limit),
+          on_plan(on_plan),
+          space(planning_task.initial_state.num_words()) {}
+
+    // @return The cheapest plan found within the time limit, empty if none
+    std::vector<int> search() {
+        statistics = SearchStatistics();
+        StateID root_state_id =
+            space.registry
+                .insert(planning_task.initial_state,
+                        planning_task.get_hash(planning_task.initial_state))
+                .first;
+        space.add_node(make_root_node(root_state_id));
+        h_values.push_back(heuristic.calculate_h(0, space));
+        statistics.evaluated++;
+        std::cout << "Initial h value: " << h_values[0] << "\n";
+
+        for (float weight : weights) {
+            SearchStatistics before = statistics;
+            int status = run(weight);
+            std::cout << "weight " << weight << ": "
+                      << statistics.expanded - before.expanded
+                      << " expanded, cost "
+                      << (incumbent < INF ? incumbent : -1) << "\n";
+            if (status != IMPROVED || weight <= 1) {
+                break;
+            }
+        }
+        statistics.print();
+        std::cout << space.committed_bytes() << " Bytes committed\n";
+        if (incumbent == INF) {
+            std::cerr << "No solution found" << std::endl;
+        }
+        return solution;
+    }
+
+   private:
+    enum { IMPROVED, EXHAUSTED, TIMEOUT };
+
+    BaseTask& planning_task;
+    Heuristic& heuristic;
+    double time_limit;
+    std::function<void(const std::vector<int>&)> on_plan;
+    SearchSpace space;
+    // heuristic value of each state
+    std::vector<float> h_values;
+    // the run in which each state was queued last
+    std::vector<int> queued_in;
+    // g value with which each state was expanded in the current run
+    std::vector<int> expanded_g;
+    int num_runs = 0;
+    int incumbent = INF;
+    std::vector<int> solution;
+
+    bool timed_out() const {
+        return time_limit > 0 && statistics.elapsed_ms() >= time_limit * 1000;
+    }
+
+    // Queue state "id" with its cheapest known path unless it is pruned
+    template <typename OpenList>
+    void push(OpenList& queue, const BestFirstKey& key, StateID id) {
+        float h = h_values[id];
+        queued_in[id] = num_runs;
+        if (h < FLOAT_INF && space[id].g + h < incumbent) {
+            key.push(queue, id, space[id].g, h);
+        }
+    }
+
+    int run(float weight) {
+        num_runs++;
+        BestFirstConfig config;
+        config.weight = weight;
+        BestFirstKey key(config);
+        HeapOpenList queue;
+        queued_in.resize(space.size(), 0);
+        expanded_g.assign(space.size(), INF);
+        push(queue, key, 0);
+
+        while (!queue.empty()) {
+            if (timed_out()) {
+                return TIMEOUT;
+            }
+            int node_idx = queue.pop();
+            int g = space[node_idx].g;
+            if (expanded_g[node_idx] <= g ||
+                g + h_values[node_idx] >= incumbent) {
+                continue;
+            }
+            statistics.expanded++;
+            expanded_g[node_idx] = g;
+            if (planning_task.goal_reached(space.state(node_idx))) {
+                solution = extract_solution(node_idx, space);
+                incumbent = (int)solution.size();
+                on_plan(solution);
+                return IMPROVED;
+            }
+
+            planning_task.for_each_successor(
+                space.state(node_idx), space.hash(node_idx),
+                [&](const Successor& succ) {
+                    statistics.generated++;
+                    auto [succ_id, is_new] = space.registry.insert(succ);
+                    if (is_new) {
+                        space.add_node(make_child_node(node_idx, g,
+                                                       succ.action, succ_id));
+                        h_values.push_back(
+                            heuristic.calculate_h(succ_id, space));
+                        statistics.evaluated++;
+                        queued_in.push_back(0);
+                        expanded_g.push_back(INF);
+                    } else if (g + 1 < space[succ_id].g) {
+                        space[succ_id].parent_id = node_idx;
+                        space[succ_id].action = succ.action;
+                        space[succ_id].g = g + 1;
+                    } else if (queued_in[succ_id] == num_runs) {
+                        return;
+                    }
+                    push(queue, key, succ_id);
+                });
+        }
+        return EXHAUSTED;
+    }
+};
+
+/*
+Restarting weighted A*, see AnytimeSearch.
+@param time_limit: In seconds, no limit if <= 0
+@param on_plan: Called with every plan cheaper than the ones before
+*/
+inline std::vector<int> anytime_search(
+    BaseTask& planning_task, Heuristic& heuristic, double time_limit = 0,
+    std::function<void(const std::vector<int>&)> on_plan =
+        [](const std::vector<int>&) {}) {
+    AnytimeSearch search(planning_task, heuristic, time_limit, on_plan);
+    return search.search();
+}
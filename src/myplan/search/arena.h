@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Back newly created arenas with transparent huge pages (Linux only).
+inline bool arena_huge_pages = false;
+
+const size_t ARENA_CHUNK_BYTES = size_t(1) << 21;
+
+class MemoryArena {
+    /*
+    A bump allocator. Memory is taken from the system in large chunks and
+    handed out sequentially; nothing is freed before the arena itself is
+    destroyed, so allocated addresses stay valid for the arena's lifetime
+    (or until the arena is rewound past them).
+    */
+   public:
+    // A position of the arena, see mark() and rewind()
+    struct Marker {
+        size_t next_chunk;
+        char* cur;
+        size_t remaining;
+        size_t used;
+    };
+
+    explicit MemoryArena(size_t chunk_bytes = ARENA_CHUNK_BYTES,
+                         bool huge_pages = arena_huge_pages)
+        : chunk_bytes(chunk_bytes),
+          huge_pages(huge_pages),
+          cur(nullptr),
+          remaining(0),
+          committed(0),
+          used(0),
+          next_chunk(0) {}
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    ~MemoryArena() {
+        for (auto& chunk : chunks) {
+            release(chunk.first, chunk.second);
+        }
+    }
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        size_t padding = (align - ((uintptr_t)cur % align)) % align;
+        if (cur == nullptr || padding + bytes > remaining) {
+            if (next_chunk < chunks.size() &&
+                chunks[next_chunk].second >= bytes + align) {
+                // reuse a chunk released by rewind()
+                cur = (char*)chunks[next_chunk].first;
+                remaining = chunks[next_chunk].second;
+                next_chunk++;
+            } else {
+                size_t size = std::max(chunk_bytes, bytes + align);
+                cur = (char*)reserve(size);
+                remaining = size;
+                next_chunk = chunks.size();
+            }
+            padding = (align - ((uintptr_t)cur % align)) % align;
+        }
+        void* result = cur + padding;
+        cur += padding + bytes;
+        remaining -= padding + bytes;
+        used += bytes;
+        return result;
+    }
+
+    template <typename T>
+    T* allocate_array(size_t n) {
+        return (T*)allocate(n * sizeof(T), alignof(T));
+    }
+
+    Marker mark() const { return Marker{next_chunk, cur, remaining, used}; }
+
+    /*
+    Release everything allocated after "marker" was taken. The memory is
+    kept and handed out again by later allocations, so searches that
+    allocate and release in stack order (e.g. IDA*) need no more memory
+    than their deepest path.
+    */
+    void rewind(const Marker& marker) {
+        next_chunk = marker.next_chunk;
+        cur = marker.cur;
+        remaining = marker.remaining;
+        used = marker.used;
+    }
+
+    // Bytes obtained from the system
+    size_t committed_bytes() const { return committed; }
+    // Bytes handed out to callers
+    size_t used_bytes() const { return used; }
+
+   private:
+    size_t chunk_bytes;
+    bool huge_pages;
+    char* cur;
+    size_t remaining;
+    size_t committed;
+    size_t used;
+    // the chunk to continue with when the current one is full
+    size_t next_chunk;
+    std::vector<std::pair<void*, size_t>> chunks;
+
+    void* reserve(size_t size) {
+        void* p = nullptr;
+#ifdef __linux__
+        p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (huge_pages) {
+            madvise(p, size, MADV_HUGEPAGE);
+        }
+#else
+        p = std::malloc(size);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+#endif
+        chunks.emplace_back(p, size);
+        committed += size;
+        return p;
+    }
+
+    static void release(void* p, size_t size) {
+#ifdef __linux__
+        munmap(p, size);
+#else
+        (void)size;
+        std::free(p);
+#endif
+    }
+};
+
+template <typename T>
+class SegmentedArrayVector {
+    /*
+    A growable sequence of fixed-width arrays of T. Entries are stored in
+    segments taken from an arena, so growing never moves existing entries
+    and pointers to them stay valid.
+    */
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "entries are copied as raw memory");
+
+   public:
+    explicit SegmentedArrayVector(int width,
+                                  size_t segment_bytes = ARENA_CHUNK_BYTES / 2)
+        : width(width),
+          entries_per_segment(std::max<size_t>(
+              1, segment_bytes / (sizeof(T) * std::max(width, 1)))),
+          num_entries(0) {}
+
+    size_t size() const { return num_entries; }
+
+    T* operator[](size_t i) {
+        return segments[i / entries_per_segment] +
+               (i % entries_per_segment) * width;
+    }
+    const T* operator[](size_t i) const {
+        return segments[i / entries_per_segment] +
+               (i % entries_per_segment) * width;
+    }
+
+    // Append an uninitialized entry and return its address
+    T* push_back() {
+        if (num_entries == segments.size() * entries_per_segment) {
+            segments.push_back(
+                arena.allocate_array<T>(entries_per_segment * width));
+        }
+        return (*this)[num_entries++];
+    }
+
+    void pop_back() { num_entries--; }
+
+    size_t committed_bytes() const {
+        return arena.committed_bytes() + segments.capacity() * sizeof(T*);
+    }
+
+   private:
+    int width;
+    size_t entries_per_segment;
+    size_t num_entries;
+    std::vector<T*> segments;
+    MemoryArena arena;
+};
+
+template <typename T>
+class SegmentedVector {
+    /*
+    A vector whose elements never move when it grows.
+    */
+   public:
+    SegmentedVector() : entries(1) {}
+
+    size_t size() const { return entries.size(); }
+
+    T& operator[](size_t i) { return *entries[i]; }
+    const T& operator[](size_t i) const { return *entries[i]; }
+
+    T& push_back(const T& value) {
+        T* entry = entries.push_back();
+        *entry = value;
+        return *entry;
+    }
+
+    void pop_back() { entries.pop_back(); }
+
+    size_t committed_bytes() const { return entries.committed_bytes(); }
+
+   private:
+    SegmentedArrayVector<T> entries;
+};
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "open_list.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+const int INF = std::numeric_limits<int>::max();
+
+struct BestFirstConfig {
+    /*
+    Nodes are ordered by f = g + weight * h (or by h alone if "greedy") and
+    ties are broken by "tie_breaking":
+      "h": prefer lower h, "g": prefer lower g, "lifo": prefer newer nodes,
+      "auto": "g" for greedy search and "h" otherwise.
+    If "reopen_closed" is false, states are expanded at most once even if
+    a cheaper path to them is found later.
+    If "lazy", successors are queued with the heuristic value of their
+    parent and evaluated only when they are removed from the open list
+    (A* is no longer guaranteed to find optimal plans). With
+    "preferred_operators", the search additionally keeps the successors
+    reached by preferred operators of the heuristic in a second open list
+    and alternates between both lists.
+    */
+    float weight = 1;
+    bool greedy = false;
+    std::string tie_breaking = "auto";
+    bool reopen_closed = true;
+    bool lazy = false;
+    bool preferred_operators = false;
+};
+
+class BestFirstKey {
+    /*
+    Computes the open list key and tie-breaker of a node from its g and h
+    values according to a BestFirstConfig.
+    */
+   public:
+    explicit BestFirstKey(const BestFirstConfig& config)
+        : greedy(config.greedy),
+          weight(config.weight),
+          tie_breaking(config.tie_breaking) {
+        if (tie_breaking == "auto") {
+            tie_breaking = greedy ? "g" : "h";
+        }
+        if (tie_breaking != "h" && tie_breaking != "g" &&
+            tie_breaking != "lifo") {
+            throw std::invalid_argument("given tie-breaking is not supported");
+        }
+    }
+
+    template <typename OpenList>
+    void push(OpenList& queue, int node_idx, int g, float h) const {
+        float key = greedy ? h : g + weight * h;
+        float tie = 0;
+        if (tie_breaking == "h") {
+            tie = h;
+        } else if (tie_breaking == "g") {
+            tie = g;
+        }
+        queue.push(key, tie, node_idx);
+    }
+
+   private:
+    bool greedy;
+    float weight;
+    std::string tie_breaking;
+};
+
+/*
+Best-first search over the SearchSpace of the task. Nodes whose heuristic
+value is FLOAT_INF are dead ends and are not queued. The preferred
+operators of a node are collected when it is evaluated and kept until it is
+popped from an open list.
+@param queue, preferred_queue: Empty open lists (see open_list.h)
+*/
+template <typename OpenList>
+std::vector<int> best_first_search(BaseTask& planning_task,
+                                   Heuristic& heuristic, OpenList& queue,
+                                   OpenList& preferred_queue,
+                                   const BestFirstConfig& config) {
+    BestFirstKey key(config);
+    bool use_preferred = config.preferred_operators &&
+                         heuristic.provides_preferred_operators();
+
+    SearchStatistics statistics;
+    SearchSpace space(planning_task.initial_state.num_words());
+    // the preferred operators of the open nodes that have any
+    std::unordered_map<int, std::vector<int>> open_preferred;
+    // preferred operators of the node evaluated last
+    std::vector<int> preferred;
+    auto evaluate = [&](int node_idx) {
+        float h = heuristic.calculate_h(node_idx, space);
+        statistics.evaluated++;
+        if (use_preferred && h < FLOAT_INF) {
+            preferred.clear();
+            heuristic.get_preferred_operators(node_idx, space, preferred);
+            if (!preferred.empty()) {
+                open_preferred[node_idx] = preferred;
+            }
+        }
+        return h;
+    };
+    StateID root_state_id =
+        space.registry
+            .insert(planning_task.initial_state,
+                    planning_task.get_hash(planning_task.initial_state))
+            .first;
+    space.add_node(make_root_node(root_state_id));
+    float h = evaluate(0);
+    std::cout << "Initial h value: " << h << "\n";
+    if (h < FLOAT_INF) {
+        key.push(queue, 0, space[0].g, h);
+    }
+
+    // cheapest known g value of each registered state
+    std::vector<int> state_cost = {0};
+    // g value with which each state was expanded last
+    std::vector<int> expanded_g = {INF};
+    // preferred operators of the node being expanded
+    std::vector<int> expanded_preferred;
+    int node_idx, succ_g, succ_idx;
+    int turn = 0;
+
+    while (!queue.empty() || !preferred_queue.empty()) {
+        if (!preferred_queue.empty() && (queue.empty() || turn % 2 == 1)) {
+            node_idx = preferred_queue.pop();
+        } else {
+            node_idx = queue.pop();
+        }
+        turn++;
+        // a node popped once is either expanded now or outdated for good,
+        // so its preferred operators are released here
+        expanded_preferred.clear();
+        auto it = open_preferred.find(node_idx);
+        if (it != open_preferred.end()) {
+            expanded_preferred = std::move(it->second);
+            open_preferred.erase(it);
+        }
+        StateID state_id = space[node_idx].state_id;
+        int g = space[node_idx].g;
+        // skip outdated nodes and nodes already expanded from the other list
+        if (state_cost[state_id] != g || expanded_g[state_id] <= g ||
+            (!config.reopen_closed && expanded_g[state_id] != INF)) {
+            continue;
+        }
+        statistics.expanded++;
+        expanded_g[state_id] = g;
+        if (planning_task.goal_reached(space.state(node_idx))) {
+            statistics.print();
+            std::cout << space.committed_bytes() << " Bytes committed\n";
+            return extract_solution(node_idx, space);
+        }
+
+        succ_g = g + 1;
+        planning_task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                statistics.generated++;
+                // only new states are copied into the registry
+                auto [succ_state_id, is_new] = space.registry.insert(succ);
+                if (is_new) {
+                    state_cost.push_back(INF);
+                    expanded_g.push_back(INF);
+                }
+                if (succ_g < state_cost[succ_state_id] &&
+                    (config.reopen_closed || expanded_g[succ_state_id] == INF)) {
+                    state_cost[succ_state_id] = succ_g;
+                    succ_idx = space.add_node(make_child_node(
+                        node_idx, g, succ.action, succ_state_id));
+                    h = evaluate(succ_idx);
+                    if (h < FLOAT_INF) {
+                        key.push(queue, succ_idx, succ_g, h);
+                        if (std::find(expanded_preferred.begin(),
+                                      expanded_preferred.end(),
+                                      succ.action) !=
+                            expanded_preferred.end()) {
+                            key.push(preferred_queue, succ_idx, succ_g, h);
+                        }
+                    }
+                }
+            });
+    }
+
+    statistics.print();
+    std::cout << space.committed_bytes() << " Bytes committed" << std::endl;
+    std::cerr << "No solution found" << std::endl;
+    return {};  // No solution found
+}
+
+/*
+Best-first search with lazy (deferred) heuristic evaluation, see
+BestFirstConfig. Nodes are goal-tested before they are evaluated, and a
+state is expanded again only if it is reached with a lower g value (and
+"reopen_closed" is set).
+@param queue, preferred_queue: Empty open lists (see open_list.h)
+*/
+template <typename OpenList>
+std::vector<int> lazy_best_first_search(BaseTask& planning_task,
+                                        Heuristic& heuristic, OpenList& queue,
+                                        OpenList& preferred_queue,
+                                        const BestFirstConfig& config) {
+    BestFirstKey key(config);
+    bool use_preferred = config.preferred_operators &&
+                         heuristic.provides_preferred_operators();
+
+    SearchStatistics statistics;
+    SearchSpace space(planning_task.initial_state.num_words());
+    StateID root_state_id =
+        space.registry
+            .insert(planning_task.initial_state,
+                    planning_task.get_hash(planning_task.initial_state))
+            .first;
+    space.add_node(make_root_node(root_state_id));
+    key.push(queue, 0, 0, 0);
+
+    // cheapest known g value of each registered state
+    std::vector<int> state_cost = {0};
+    // g value with which each state was expanded last
+    std::vector<int> expanded_g = {INF};
+    std::vector<int> preferred;
+    int node_idx, g, succ_g, succ_idx;
+    float h;
+    int turn = 0;
+
+    while (!queue.empty() || !preferred_queue.empty()) {
+        if (!preferred_queue.empty() && (queue.empty() || turn % 2 == 1)) {
+            node_idx = preferred_queue.pop();
+        } else {
+            node_idx = queue.pop();
+        }
+        turn++;
+        StateID state_id = space[node_idx].state_id;
+        g = space[node_idx].g;
+        // skip outdated nodes and nodes already expanded from the other list
+        if (state_cost[state_id] != g || expanded_g[state_id] <= g ||
+            (!config.reopen_closed && expanded_g[state_id] != INF)) {
+            continue;
+        }
+        if (planning_task.goal_reached(space.state(node_idx))) {
+            statistics.print();
+            std::cout << space.committed_bytes() << " Bytes committed\n";
+            return extract_solution(node_idx, space);
+        }
+
+        h = heuristic.calculate_h(node_idx, space);
+        statistics.evaluated++;
+        if (node_idx == 0) {
+            std::cout << "Initial h value: " << h << "\n";
+        }
+        if (h >= FLOAT_INF) {
+            continue;
+        }
+        statistics.expanded++;
+        expanded_g[state_id] = g;
+        preferred.clear();
+        if (use_preferred) {
+            heuristic.get_preferred_operators(node_idx, space, preferred);
+        }
+
+        succ_g = g + 1;
+        planning_task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                statistics.generated++;
+                auto [succ_state_id, is_new] = space.registry.insert(succ);
+                if (is_new) {
+                    state_cost.push_back(INF);
+                    expanded_g.push_back(INF);
+                }
+                if (succ_g < state_cost[succ_state_id] &&
+                    (config.reopen_closed || expanded_g[succ_state_id] == INF)) {
+                    state_cost[succ_state_id] = succ_g;
+                    succ_idx = space.add_node(make_child_node(
+                        node_idx, g, succ.action, succ_state_id));
+                    key.push(queue, succ_idx, succ_g, h);
+                    if (std::find(preferred.begin(), preferred.end(),
+                                  succ.action) != preferred.end()) {
+                        key.push(preferred_queue, succ_idx, succ_g, h);
+                    }
+                }
+            });
+    }
+
+    statistics.print();
+    std::cout << space.committed_bytes() << " Bytes committed" << std::endl;
+    std::cerr << "No solution found" << std::endl;
+    return {};  // No solution found
+}
+
+// Run the eager or lazy search of "config" with open lists of type OpenList
+template <typename OpenList>
+std::vector<int> run_best_first_search(BaseTask& planning_task,
+                                       Heuristic& heuristic,
+                                       const BestFirstConfig& config) {
+    OpenList queue;
+    OpenList preferred_queue;
+    if (config.lazy) {
+        return lazy_best_first_search(planning_task, heuristic, queue,
+                                      preferred_queue, config);
+    }
+    return best_first_search(planning_task, heuristic, queue, preferred_queue,
+                             config);
+}
+
+// Whether all keys and ties of "config" with "heuristic" are integers
+inline bool integer_keys(Heuristic& heuristic, const BestFirstConfig& config) {
+    return heuristic.integer_valued() &&
+           (config.greedy || config.weight == std::floor(config.weight));
+}
+
+/*
+Throw if "open_list" cannot be used with "config" and "heuristic": the
+bucket queue needs integer keys, and the radix heap needs monotone keys,
+i.e. eager A* with a consistent heuristic and without preferred operators
+(the preferred queue receives successors of nodes popped from the other one).
+*/
+inline void check_open_list(const std::string& open_list,
+                            Heuristic& heuristic,
+                            const BestFirstConfig& config) {
+    if (open_list == "bucket" && !integer_keys(heuristic, config)) {
+        throw std::invalid_argument(
+            "the bucket open list requires an integer-valued heuristic and "
+            "an integer weight");
+    }
+    if (open_list == "radix" &&
+        (config.greedy || config.weight != 1 || config.lazy ||
+         !heuristic.consistent() ||
+         (config.preferred_operators &&
+          heuristic.provides_preferred_operators()))) {
+        throw std::invalid_argument(
+            "the radix open list requires eager A* with a consistent "
+            "heuristic and without preferred operators");
+    }
+}
+
+/*
+@param open_list: "bucket", "radix", "heap" or "auto" (a bucket queue if all
+keys are integers and a binary heap otherwise)
+*/
+inline std::vector<int> best_first_search(BaseTask& planning_task,
+                                          Heuristic& heuristic,
+                                          const BestFirstConfig& config,
+                                          const std::string& open_list) {
+    check_open_list(open_list, heuristic, config);
+    if (open_list == "bucket" ||
+        (open_list == "auto" && integer_keys(heuristic, config))) {
+        return run_best_first_search<BucketOpenList>(planning_task, heuristic,
+                                                     config);
+    } else if (open_list == "radix") {
+        return run_best_first_search<RadixHeapOpenList>(planning_task,
+                                                        heuristic, config);
+    } else if (open_list == "heap" || open_list == "auto") {
+        return run_best_first_search<HeapOpenList>(planning_task, heuristic,
+                                                   config);
+    }
+    throw std::invalid_argument("given open list is not supported");
+}
+
+// Greedy best-first search: order by h, prefer lower g among equal h
+inline std::vector<int> gbfs(BaseTask& planning_task, Heuristic& heuristic,
+                             BestFirstConfig config = BestFirstConfig(),
+                             const std::string& open_list = "auto") {
+    config.greedy = true;
+    return best_first_search(planning_task, heuristic, config, open_list);
+}
+
+// Weighted A*: order by g + weight * h
+inline std::vector<int> wastar(BaseTask& planning_task, Heuristic& heuristic,
+                               float weight,
+                               BestFirstConfig config = BestFirstConfig(),
+                               const std::string& open_list = "auto") {
+    config.greedy = false;
+    config.weight = weight;
+    return best_first_search(planning_task, heuristic, config, open_list);
+}
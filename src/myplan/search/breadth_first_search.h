@@ -15,12 +15,15 @@
 inline std::vector<int> breadth_first_search(BaseTask& planning_task) {
     int iteration = 0;
     std::queue<int> queue;
-    std::vector<SearchNode> nodes;
-    nodes.push_back(make_root_node(planning_task.initial_state));
+    SearchSpace space(planning_task.initial_state.num_words());
+    StateID root_state_id =
+        space.registry
+            .insert(planning_task.initial_state,
+                    planning_task.get_hash(planning_task.initial_state))
+            .first;
+    space.add_node(make_root_node(root_state_id));
     queue.push(0);
 
-    flat_hash_set<size_t> closed = {nodes[0].hash_value};
-    std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>> successors;
     int node_idx;
     while (!queue.empty()) {
         ++iteration;
@@ -28,25 +31,28 @@ inline std::vector<int> breadth_first_search(BaseTask& planning_task) {
         node_idx = queue.front();
         queue.pop();
 
-        if (planning_task.goal_reached(nodes[node_idx].state)) {
+        if (planning_task.goal_reached(space.state(node_idx))) {
             std::cout << iteration << " Nodes expanded" << std::endl;
-            return extract_solution(node_idx, nodes);
-        }
-        successors.clear();
-        planning_task.get_successor_states(nodes[node_idx].state, successors,
-                                           nodes[node_idx].hash_value);
-        for (auto& opss : successors) {
-            if (closed.find(opss.second.first) == closed.end()) {
-                nodes.emplace_back(
-                    make_child_node(node_idx, nodes[node_idx].g, opss.first,
-                                    opss.second.second, opss.second.first));
-                queue.push(nodes.size() - 1);
-                closed.emplace(opss.second.first);
-            }
+            std::cout << space.committed_bytes() << " Bytes committed"
+                      << std::endl;
+            return extract_solution(node_idx, space);
         }
+        planning_task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                // the registry is the closed list: only new states are
+                // copied into it and queued
+                auto [succ_state_id, is_new] = space.registry.insert(succ);
+                if (is_new) {
+                    queue.push(space.add_node(
+                        make_child_node(node_idx, space[node_idx].g,
+                                        succ.action, succ_state_id)));
+                }
+            });
     }
 
     std::cout << iteration << " Nodes expanded" << std::endl;
+    std::cout << space.committed_bytes() << " Bytes committed" << std::endl;
     std::cerr << "No solution found" << std::endl;
     return {};
 }
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "best_first_search.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+class EnforcedHillClimbing {
+    /*
+    Enforced hill-climbing (Hoffmann and Nebel 2001): from the current node,
+    a breadth-first search looks for a node with a strictly lower heuristic
+    value, which becomes the new current node. The plan is the
+    concatenation of the paths found by these searches.
+
+    With "helpful_actions", only the preferred operators of the heuristic
+    (e.g. the applicable operators of a relaxed plan, see
+    _RelaxationHeuristic) are applied to a node; they are queried right
+    after the node is evaluated and kept with it in the queue. Heuristics
+    without preferred operators apply all operators.
+
+    All breadth-first searches share one SearchSpace, so the path to any
+    node leads back to the initial state, but a state is only pruned as a
+    duplicate within the search that reached it.
+    */
+   public:
+    SearchStatistics statistics;
+    // the number of breadth-first searches that found a better node
+    int improvements = 0;
+    // true if a breadth-first search exhausted its states
+    bool failed = false;
+
+    EnforcedHillClimbing(BaseTask& planning_task, Heuristic& heuristic,
+                         bool helpful_actions = false)
+        : planning_task(planning_task),
+          heuristic(heuristic),
+          helpful_actions(helpful_actions &&
+                          heuristic.provides_preferred_operators()),
+          space(planning_task.initial_state.num_words()) {}
+
+    // @return A plan, empty if the initial state is a goal or if "failed"
+    std::vector<int> search() {
+        statistics = SearchStatistics();
+        failed = false;
+        StateID root_state_id =
+            space.registry
+                .insert(planning_task.initial_state,
+                        planning_task.get_hash(planning_task.initial_state))
+                .first;
+        space.add_node(make_root_node(root_state_id));
+        float h = heuristic.calculate_h(0, space);
+        statistics.evaluated++;
+        std::cout << "Initial h value: " << h << "\n";
+        int current = h < FLOAT_INF ? improve(0, h) : -1;
+        statistics.print();
+        std::cout << improvements << " Improvements\n";
+        std::cout << space.committed_bytes() << " Bytes committed\n";
+        if (current == -1) {
+            failed = true;
+            std::cerr << "Enforced hill-climbing failed" << std::endl;
+            return {};
+        }
+        return extract_solution(current, space);
+    }
+
+   private:
+    // a queued node and its helpful actions in "helpful"
+    struct Entry {
+        int node;
+        int begin;
+        int end;
+    };
+
+    BaseTask& planning_task;
+    Heuristic& heuristic;
+    bool helpful_actions;
+    SearchSpace space;
+    std::deque<Entry> queue;
+    std::vector<int> helpful;
+    // the search in which each state was reached last
+    std::vector<int> reached_in;
+
+    // Append the helpful actions of the node evaluated last to "helpful"
+    Entry make_entry(int node_idx) {
+        int begin = (int)helpful.size();
+        if (helpful_actions) {
+            heuristic.get_preferred_operators(node_idx, space, helpful);
+        }
+        return Entry{node_idx, begin, (int)helpful.size()};
+    }
+
+    // @return The goal node reached from "node_idx", -1 if none was found
+    int improve(int node_idx, float h) {
+        int num_searches = 0;
+        reached_in.assign(1, 0);
+        while (!planning_task.goal_reached(space.state(node_idx))) {
+            num_searches++;
+            queue.clear();
+            helpful.clear();
+            reached_in[space[node_idx].state_id] = num_searches;
+            queue.push_back(make_entry(node_idx));
+            int better = -1;
+            float better_h = h;
+            while (!queue.empty() && better == -1) {
+                Entry entry = queue.front();
+                queue.pop_front();
+                statistics.expanded++;
+                int g = space[entry.node].g;
+                planning_task.for_each_successor(
+                    space.state(entry.node), space.hash(entry.node),
+                    [&](const Successor& succ) {
+                        statistics.generated++;
+                        if (better != -1 ||
+                            (helpful_actions &&
+                             std::find(helpful.begin() + entry.begin,
+                                       helpful.begin() + entry.end,
+                                       succ.action) ==
+                                 helpful.begin() + entry.end)) {
+                            return;
+                        }
+                        auto [succ_state_id, is_new] =
+                            space.registry.insert(succ);
+                        if (is_new) {
+                            reached_in.push_back(0);
+                        }
+                        if (reached_in[succ_state_id] == num_searches) {
+                            return;
+                        }
+                        reached_in[succ_state_id] = num_searches;
+                        int succ_idx = space.add_node(make_child_node(
+                            entry.node, g, succ.action, succ_state_id));
+                        float succ_h = heuristic.calculate_h(succ_idx, space);
+                        statistics.evaluated++;
+                        if (succ_h < better_h ||
+                            planning_task.goal_reached(
+                                space.state(succ_idx))) {
+                            better = succ_idx;
+                            better_h = succ_h;
+                        } else if (succ_h < FLOAT_INF) {
+                            queue.push_back(make_entry(succ_idx));
+                        }
+                    });
+            }
+            if (better == -1) {
+                return -1;
+            }
+            improvements++;
+            node_idx = better;
+            h = better_h;
+        }
+        return node_idx;
+    }
+};
+
+/*
+Enforced hill-climbing, see EnforcedHillClimbing. If it fails, greedy
+best-first search is run from the initial state instead.
+@param helpful_actions: Only apply the preferred operators of the heuristic
+@param open_list: The open list of the greedy best-first search
+*/
+inline std::vector<int> enforced_hill_climbing(
+    BaseTask& planning_task, Heuristic& heuristic, bool helpful_actions = false,
+    const std::string& open_list = "auto") {
+    BestFirstConfig fallback_config;
+    fallback_config.greedy = true;
+    check_open_list(open_list, heuristic, fallback_config);
+    EnforcedHillClimbing search(planning_task, heuristic, helpful_actions);
+    std::vector<int> solution = search.search();
+    if (!search.failed) {
+        return solution;
+    }
+    std::cout << "Falling back to greedy best-first search\n";
+    return best_first_search(planning_task, heuristic, fallback_config,
+                             open_list);
+}
@@ -0,0 +1,359 @@
+#pragma once
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../task.h"
+#include "record_file.h"
+
+struct ExternalSearchConfig {
+    /*
+    "directory": where the layer files are created (a new temporary
+    directory if empty), "memory_bytes": the size of the buffer in which
+    successors are sorted before they are written as a run (including the
+    index used for sorting), "direct_io": open the files with O_DIRECT if
+    possible.
+    "duplicate_layers": the number of previous layers a new layer is
+    checked against, 0 for all. Merging against all layers opens one file
+    per layer and reads every earlier layer again for each new one. If all
+    operators can be undone, duplicates of layer d + 1 can only be in
+    layers d and d - 1, so 2 suffices; otherwise old states may be
+    expanded again, which keeps plans shortest but may not terminate on
+    unsolvable tasks.
+    */
+    std::string directory = "";
+    size_t memory_bytes = size_t(256) << 20;
+    bool direct_io = false;
+    int duplicate_layers = 0;
+};
+
+class ExternalBreadthFirstSearch {
+    /*
+    Breadth-first search whose layers live on disk. Every layer is a file
+    of packed states sorted lexicographically by their words and without
+    duplicates. Expanding a layer fills a memory buffer with successors;
+    whenever it is full it is sorted and written as a run. The runs are
+    then merged, and states occurring in an earlier layer (see
+    ExternalSearchConfig::duplicate_layers) are dropped by reading the
+    (sorted) layer files alongside (delayed duplicate detection). All file
+    accesses are sequential.
+
+    No parent pointers are stored: the plan is recovered backwards by
+    scanning each layer for a predecessor of the state reached.
+    */
+   public:
+    // bytes read and written over the whole search
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    long expanded = 0;
+
+    ExternalBreadthFirstSearch(BaseTask& planning_task,
+                               const ExternalSearchConfig& config)
+        : planning_task(planning_task),
+          config(config),
+          num_words(planning_task.initial_state.num_words()),
+          record_size(num_words * sizeof(uint64_t)) {
+        directory = config.directory;
+        if (directory.empty()) {
+            std::string pattern =
+                (std::filesystem::temp_directory_path() / "myplan-XXXXXX")
+                    .string();
+            if (mkdtemp(pattern.data()) == nullptr) {
+                throw std::runtime_error("cannot create a temporary directory");
+            }
+            directory = pattern;
+            created_directory = true;
+        }
+    }
+
+    ExternalBreadthFirstSearch(const ExternalBreadthFirstSearch&) = delete;
+    ExternalBreadthFirstSearch& operator=(const ExternalBreadthFirstSearch&) =
+        delete;
+
+    ~ExternalBreadthFirstSearch() {
+        std::error_code error;
+        for (const std::string& path : layers) {
+            std::filesystem::remove(path, error);
+        }
+        if (created_directory) {
+            std::filesystem::remove_all(directory, error);
+        }
+    }
+
+    // @return A shortest plan or an empty vector if none exists
+    std::vector<int> search() {
+        const State& init = planning_task.initial_state;
+        {
+            RecordWriter writer(layer_path(0), record_size, config.direct_io);
+            writer.write(init.words.data());
+            writer.close();
+            bytes_written += writer.io_bytes();
+        }
+        layers.push_back(layer_path(0));
+        if (planning_task.goal_reached(init)) {
+            report();
+            return {};
+        }
+
+        std::vector<uint64_t> goal;
+        for (int depth = 0; goal.empty(); depth++) {
+            size_t read_before = bytes_read, written_before = bytes_written;
+            size_t layer_size = expand_layer(depth, goal);
+            std::cout << "Layer " << depth + 1 << ": " << layer_size
+                      << " states, " << bytes_read - read_before
+                      << " bytes read, " << bytes_written - written_before
+                      << " bytes written" << std::endl;
+            if (layer_size == 0) {
+                report();
+                std::cerr << "No solution found" << std::endl;
+                return {};
+            }
+        }
+        report();
+        return recover_plan(goal);
+    }
+
+   private:
+    BaseTask& planning_task;
+    ExternalSearchConfig config;
+    int num_words;
+    size_t record_size;
+    std::string directory;
+    bool created_directory = false;
+    std::vector<std::string> layers;
+    int num_runs = 0;
+    // the successor buffer and the sort order of its records, allocated
+    // once with the capacity given by "config.memory_bytes"
+    std::vector<uint64_t> buffer;
+    std::vector<uint32_t> order;
+
+    std::string layer_path(int depth) const {
+        return directory + "/layer-" + std::to_string(depth) + ".bin";
+    }
+
+    int compare(const void* a, const void* b) const {
+        const uint64_t* x = (const uint64_t*)a;
+        const uint64_t* y = (const uint64_t*)b;
+        for (int i = 0; i < num_words; i++) {
+            if (x[i] != y[i]) {
+                return x[i] < y[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    void report() const {
+        std::cout << expanded << " Nodes expanded" << std::endl;
+        std::cout << bytes_read << " Bytes read" << std::endl;
+        std::cout << bytes_written << " Bytes written" << std::endl;
+    }
+
+    /*
+    Write the successors of layer "depth" to the file of layer depth + 1.
+    If a goal is generated, "goal" is set to it and expansion stops.
+    @return The number of states in the new layer
+    */
+    size_t expand_layer(int depth, std::vector<uint64_t>& goal) {
+        // at most UINT32_MAX records, so that "order" can index them
+        size_t max_records = std::clamp<size_t>(
+            config.memory_bytes / (record_size + sizeof(uint32_t)), 1,
+            UINT32_MAX);
+        buffer.reserve(max_records * num_words);
+        order.reserve(max_records);
+        std::vector<std::string> runs;
+        {
+            RecordReader reader(layers[depth], record_size, config.direct_io);
+            State state(num_words * 64);
+            for (; !reader.done() && goal.empty(); reader.next()) {
+                std::memcpy(state.words.data(), reader.current(),
+                            record_size);
+                expanded++;
+                planning_task.for_each_successor(
+                    state, planning_task.get_hash(state),
+                    [&](const Successor& succ) {
+                        // never grows beyond the reserved capacity
+                        size_t offset = buffer.size();
+                        buffer.resize(offset + num_words);
+                        succ.write(buffer.data() + offset, num_words);
+                        if (goal.empty() &&
+                            planning_task.goal_reached(StateView(
+                                buffer.data() + offset, num_words))) {
+                            goal.assign(buffer.begin() + offset,
+                                        buffer.end());
+                        }
+                        if (buffer.size() >= max_records * num_words) {
+                            runs.push_back(write_run());
+                        }
+                    });
+            }
+            bytes_read += reader.io_bytes();
+        }
+        if (!buffer.empty()) {
+            runs.push_back(write_run());
+        }
+        size_t layer_size = merge_runs(runs, layer_path(depth + 1));
+        layers.push_back(layer_path(depth + 1));
+        return layer_size;
+    }
+
+    // Sort "buffer", write it without duplicates to a new file and clear it
+    std::string write_run() {
+        size_t n = buffer.size() / num_words;
+        order.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            order[i] = (uint32_t)i;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return compare(&buffer[(size_t)a * num_words],
+                           &buffer[(size_t)b * num_words]) < 0;
+        });
+        std::string path = directory + "/run-" + std::to_string(num_runs++) +
+                           ".bin";
+        RecordWriter writer(path, record_size, config.direct_io);
+        const uint64_t* last = nullptr;
+        for (uint32_t i : order) {
+            const uint64_t* record = &buffer[(size_t)i * num_words];
+            if (last == nullptr || compare(last, record) != 0) {
+                writer.write(record);
+                last = record;
+            }
+        }
+        writer.close();
+        bytes_written += writer.io_bytes();
+        buffer.clear();
+        return path;
+    }
+
+    /*
+    Merge the sorted runs into the file "path", dropping duplicates and the
+    states of the last "config.duplicate_layers" layers (all if 0); the
+    runs are deleted.
+    @return The number of states written
+    */
+    size_t merge_runs(const std::vector<std::string>& runs,
+                      const std::string& path) {
+        std::vector<std::unique_ptr<RecordReader>> inputs, previous;
+        for (const std::string& run : runs) {
+            inputs.push_back(std::make_unique<RecordReader>(run, record_size,
+                                                            config.direct_io));
+        }
+        size_t first_layer =
+            config.duplicate_layers > 0 &&
+                    layers.size() > (size_t)config.duplicate_layers
+                ? layers.size() - config.duplicate_layers
+                : 0;
+        for (size_t d = first_layer; d < layers.size(); d++) {
+            previous.push_back(std::make_unique<RecordReader>(
+                layers[d], record_size, config.direct_io));
+        }
+        auto greater = [&](int a, int b) {
+            return compare(inputs[a]->current(), inputs[b]->current()) > 0;
+        };
+        std::priority_queue<int, std::vector<int>, decltype(greater)> heap(
+            greater);
+        for (int i = 0; i < (int)inputs.size(); i++) {
+            if (!inputs[i]->done()) {
+                heap.push(i);
+            }
+        }
+
+        RecordWriter writer(path, record_size, config.direct_io);
+        std::vector<uint64_t> last(num_words);
+        bool has_last = false;
+        while (!heap.empty()) {
+            int i = heap.top();
+            heap.pop();
+            const void* record = inputs[i]->current();
+            if (!has_last || compare(last.data(), record) != 0) {
+                std::memcpy(last.data(), record, record_size);
+                has_last = true;
+                bool seen = false;
+                for (auto& layer : previous) {
+                    while (!layer->done() &&
+                           compare(layer->current(), last.data()) < 0) {
+                        layer->next();
+                    }
+                    if (!layer->done() &&
+                        compare(layer->current(), last.data()) == 0) {
+                        seen = true;
+                        break;
+                    }
+                }
+                if (!seen) {
+                    writer.write(last.data());
+                }
+            }
+            inputs[i]->next();
+            if (!inputs[i]->done()) {
+                heap.push(i);
+            }
+        }
+        writer.close();
+        bytes_written += writer.io_bytes();
+        size_t layer_size = writer.size();
+
+        for (auto& reader : inputs) {
+            bytes_read += reader->io_bytes();
+        }
+        for (auto& reader : previous) {
+            bytes_read += reader->io_bytes();
+        }
+        inputs.clear();
+        std::error_code error;
+        for (const std::string& run : runs) {
+            std::filesystem::remove(run, error);
+        }
+        return layer_size;
+    }
+
+    // Find a path to "goal" (in the last layer) by scanning the layers
+    std::vector<int> recover_plan(std::vector<uint64_t> target) {
+        std::vector<int> plan;
+        State state(num_words * 64);
+        for (int depth = (int)layers.size() - 2; depth >= 0; depth--) {
+            int action = -1;
+            RecordReader reader(layers[depth], record_size, config.direct_io);
+            for (; !reader.done() && action == -1; reader.next()) {
+                std::memcpy(state.words.data(), reader.current(),
+                            record_size);
+                planning_task.for_each_successor(
+                    state, planning_task.get_hash(state),
+                    [&](const Successor& succ) {
+                        if (action == -1 &&
+                            succ.equals(target.data(), num_words)) {
+                            action = succ.action;
+                        }
+                    });
+                if (action != -1) {
+                    target = state.words;
+                }
+            }
+            bytes_read += reader.io_bytes();
+            plan.push_back(action);
+        }
+        std::reverse(plan.begin(), plan.end());
+        return plan;
+    }
+};
+
+/*
+Breadth-first search that keeps its layers in files, see
+ExternalBreadthFirstSearch.
+*/
+inline std::vector<int> external_breadth_first_search(
+    BaseTask& planning_task,
+    const ExternalSearchConfig& config = ExternalSearchConfig()) {
+    ExternalBreadthFirstSearch search(planning_task, config);
+    return search.search();
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../task.h"
+#include "state_registry.h"
+
+class FrontierSearch {
+    /*
+    Breadth-first search that only keeps the previous, current and next
+    layer in memory. A successor is a duplicate if it occurs in one of these
+    layers; states of older layers may be generated again, which costs time
+    but never hides a shorter plan, so the depth of the first goal found is
+    still the optimal plan length. (In tasks with long cycles and no
+    solution the layers may never run empty, which "max_depth" guards
+    against.)
+
+    The plan is recovered by divide and conquer: once the goal depth d is
+    known, the search is repeated while every node of the layers beyond d/2
+    remembers its ancestor in layer d/2 (the relay layer). The relay state
+    on the path to the goal splits the task into two halves that are solved
+    the same way.
+    */
+   public:
+    long expanded = 0;
+    // the largest number of bytes held by the layers at one time
+    size_t peak_bytes = 0;
+
+    explicit FrontierSearch(BaseTask& planning_task,
+                            int max_depth = std::numeric_limits<int>::max())
+        : planning_task(planning_task),
+          max_depth(max_depth),
+          num_words(planning_task.initial_state.num_words()) {}
+
+    // @return A shortest plan or an empty vector if none was found
+    std::vector<int> search() {
+        State goal;
+        int depth = layered_search(planning_task.initial_state, nullptr, -1,
+                                   goal, nullptr);
+        std::cout << expanded << " Nodes expanded" << std::endl;
+        if (depth < 0) {
+            std::cout << peak_bytes << " Bytes committed" << std::endl;
+            std::cerr << "No solution found" << std::endl;
+            return {};
+        }
+        std::vector<int> plan;
+        solve(planning_task.initial_state, goal, depth, plan);
+        std::cout << expanded << " Nodes expanded including plan recovery"
+                  << std::endl;
+        std::cout << peak_bytes << " Bytes committed" << std::endl;
+        return plan;
+    }
+
+   private:
+    BaseTask& planning_task;
+    int max_depth;
+    int num_words;
+
+    // Append a plan of length "depth" from "start" to "goal" to "plan"
+    void solve(const State& start, const State& goal, int depth,
+               std::vector<int>& plan) {
+        if (depth == 0) {
+            return;
+        }
+        if (depth == 1) {
+            int action = -1;
+            planning_task.for_each_successor(
+                start, planning_task.get_hash(start),
+                [&](const Successor& succ) {
+                    if (action == -1 &&
+                        succ.equals(goal.words.data(), num_words)) {
+                        action = succ.action;
+                    }
+                });
+            plan.push_back(action);
+            return;
+        }
+        State reached, relay;
+        int relay_depth = depth / 2;
+        if (layered_search(start, &goal, relay_depth, reached, &relay) !=
+            depth) {
+            throw std::logic_error("the goal depth has changed");
+        }
+        solve(start, relay, relay_depth, plan);
+        solve(relay, goal, depth - relay_depth, plan);
+    }
+
+    /*
+    Layered breadth-first search from "start" to "target" (or to the goal
+    of the task if "target" is null).
+    @param goal: Set to the goal state found
+    @param relay: If not null, set to the ancestor of "goal" in layer
+    "relay_depth"
+    @return The depth of the goal or -1 if it was not found
+    */
+    int layered_search(const State& start, const State* target,
+                       int relay_depth, State& goal, State* relay) {
+        auto is_goal = [&](const StateView& state) {
+            if (target == nullptr) {
+                return planning_task.goal_reached(state);
+            }
+            for (int i = 0; i < num_words; i++) {
+                if (state.word(i) != target->words[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto copy_state = [&](const StateView& state, State& result) {
+            result = State(num_words * 64);
+            for (int i = 0; i < num_words; i++) {
+                result.words[i] = state.word(i);
+            }
+        };
+
+        auto prev = std::make_unique<StateRegistry>(num_words);
+        auto cur = std::make_unique<StateRegistry>(num_words);
+        auto next = std::make_unique<StateRegistry>(num_words);
+        // index of the ancestor of each state of cur/next in the relay layer
+        std::vector<int> cur_relay, next_relay;
+        std::vector<uint64_t> relay_layer;
+
+        cur->insert(start, planning_task.get_hash(start));
+        cur_relay.push_back(0);
+        if (is_goal(start)) {
+            copy_state(start, goal);
+            if (relay != nullptr) {
+                *relay = goal;
+            }
+            return 0;
+        }
+
+        for (int depth = 0; depth < max_depth && cur->size() > 0; depth++) {
+            if (depth == relay_depth) {
+                // keep the states of the relay layer
+                for (int id = 0; id < cur->size(); id++) {
+                    StateView state = cur->lookup(id);
+                    for (int i = 0; i < num_words; i++) {
+                        relay_layer.push_back(state.word(i));
+                    }
+                    cur_relay[id] = id;
+                }
+            }
+            int found = NO_STATE;
+            for (int id = 0; id < cur->size() && found == NO_STATE; id++) {
+                expanded++;
+                planning_task.for_each_successor(
+                    cur->lookup(id), cur->hash(id),
+                    [&](const Successor& succ) {
+                        if (found != NO_STATE ||
+                            prev->find(succ) != NO_STATE ||
+                            cur->find(succ) != NO_STATE) {
+                            return;
+                        }
+                        auto [succ_id, is_new] = next->insert(succ);
+                        if (!is_new) {
+                            return;
+                        }
+                        next_relay.push_back(cur_relay[id]);
+                        if (is_goal(next->lookup(succ_id))) {
+                            found = succ_id;
+                        }
+                    });
+            }
+            peak_bytes = std::max(peak_bytes, prev->committed_bytes() +
+                                                  cur->committed_bytes() +
+                                                  next->committed_bytes() +
+                                                  relay_layer.capacity() *
+                                                      sizeof(uint64_t));
+            if (found != NO_STATE) {
+                copy_state(next->lookup(found), goal);
+                if (relay != nullptr) {
+                    if (depth + 1 == relay_depth) {
+                        *relay = goal;
+                    } else {
+                        copy_state(
+                            StateView(relay_layer.data() +
+                                          (size_t)next_relay[found] * num_words,
+                                      num_words),
+                            *relay);
+                    }
+                }
+                return depth + 1;
+            }
+            prev = std::move(cur);
+            cur = std::move(next);
+            next = std::make_unique<StateRegistry>(num_words);
+            cur_relay.swap(next_relay);
+            next_relay.clear();
+        }
+        return -1;
+    }
+};
+
+/*
+Breadth-first search that keeps only three layers of states in memory and
+recovers the plan by divide and conquer, see FrontierSearch.
+@param max_depth: Give up after this many layers
+*/
+inline std::vector<int> frontier_breadth_first_search(
+    BaseTask& planning_task, int max_depth = std::numeric_limits<int>::max()) {
+    FrontierSearch search(planning_task, max_depth);
+    return search.search();
+}
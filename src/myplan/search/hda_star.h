@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "best_first_search.h"
+#include "mpsc_queue.h"
+#include "open_list.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+// Creates a new heuristic instance (one per search thread)
+typedef std::function<std::unique_ptr<Heuristic>()> HeuristicFactory;
+
+// A generated node sent to the thread that owns its state
+struct HDAMessage {
+    state_hash_t hash;
+    int g;
+    float h;
+    int action;
+    // the node of the sender that generated the message
+    int origin;
+    const uint64_t* unreached;
+};
+
+struct HDABatch {
+    int sender;
+    std::vector<HDAMessage> messages;
+    // the packed states of the messages back to back
+    std::vector<uint64_t> words;
+    std::atomic<HDABatch*> next{nullptr};
+};
+
+class HDAStar {
+    /*
+    Hash-distributed A* (Kishimoto, Fukunaga and Botea 2009). Every state is
+    owned by one thread, chosen by its Zobrist hash. Each thread has its own
+    search space, open list and heuristic instance and only expands the
+    states it owns. Successors owned by another thread are evaluated by the
+    generating thread (so that path dependent heuristics can read the
+    parent node) and sent to the owner in batches through lock-free queues.
+    The registry of a thread also remembers the remote states it has sent,
+    so they are only sent again when reached on a cheaper path.
+
+    Goals are detected when they are generated and the cheapest one is kept
+    as the incumbent; nodes with f >= the incumbent cost are pruned. The
+    search ends when all threads are idle and no message is in flight, so
+    the incumbent is optimal for admissible heuristics.
+    */
+   public:
+    // summed over all threads
+    SearchStatistics statistics;
+    long messages_sent = 0;
+
+    /*
+    @param open_list: "bucket", "heap" or "auto" (a bucket queue for
+    integer-valued heuristics and a binary heap otherwise)
+    @param batch_size: The number of messages sent to a thread at once
+    */
+    HDAStar(BaseTask& planning_task, HeuristicFactory make_heuristic,
+            int num_threads, const std::string& open_list = "auto",
+            int batch_size = 32)
+        : planning_task(planning_task),
+          make_heuristic(make_heuristic),
+          num_threads(num_threads),
+          open_list(open_list),
+          batch_size(batch_size) {
+        if (num_threads < 1) {
+            throw std::invalid_argument("at least one thread is required");
+        }
+        if (open_list != "bucket" && open_list != "heap" &&
+            open_list != "auto") {
+            throw std::invalid_argument("given open list is not supported");
+        }
+    }
+
+    HDAStar(const HDAStar&) = delete;
+    HDAStar& operator=(const HDAStar&) = delete;
+
+    ~HDAStar() {
+        for (auto& worker : workers) {
+            for (HDABatch* batch : worker->outbox) {
+                delete batch;
+            }
+            while (HDABatch* batch = worker->inbox.pop()) {
+                delete batch;
+            }
+        }
+    }
+
+    std::vector<int> search() {
+        statistics = SearchStatistics();
+        int num_words = planning_task.initial_state.num_words();
+        workers.clear();
+        for (int i = 0; i < num_threads; i++) {
+            workers.push_back(std::make_unique<Worker>(i, num_words));
+            workers[i]->outbox.assign(num_threads, nullptr);
+            workers[i]->heuristic = make_heuristic();
+            // the bucket queue would round fractional keys
+            if (open_list == "bucket" &&
+                !workers[i]->heuristic->integer_valued()) {
+                throw std::invalid_argument(
+                    "the bucket open list requires an integer-valued "
+                    "heuristic");
+            }
+        }
+        root_hash = planning_task.get_hash(planning_task.initial_state);
+        int root_owner = owner(root_hash);
+        for (auto& worker : workers) {
+            worker->idle = worker->id != root_owner;
+        }
+        activity = (uint64_t)(num_threads - 1) << 32;
+        incumbent = INF;
+        solution_thread = -1;
+        done = false;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; i++) {
+            threads.emplace_back([this, i]() { work(*workers[i]); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        messages_sent = 0;
+        size_t committed = 0;
+        for (auto& worker : workers) {
+            statistics.expanded += worker->statistics.expanded;
+            statistics.evaluated += worker->statistics.evaluated;
+            statistics.generated += worker->statistics.generated;
+            messages_sent += worker->messages_sent;
+            committed += worker->space.committed_bytes();
+        }
+        statistics.print();
+        std::cout << messages_sent << " Messages sent\n";
+        std::cout << committed << " Bytes committed" << std::endl;
+
+        if (solution_thread == -1) {
+            std::cerr << "No solution found" << std::endl;
+            return {};  // No solution found
+        }
+        return extract_plan();
+    }
+
+   private:
+    struct Worker {
+        int id;
+        SearchSpace space;
+        std::unique_ptr<Heuristic> heuristic;
+        // cheapest known g value of each registered state (for states of
+        // other threads: the cheapest one sent)
+        std::vector<int> state_cost;
+        // heuristic value of each node
+        std::vector<float> node_h;
+        // (thread, node) that generated a node received from another
+        // thread, (-1, -1) for nodes generated locally
+        std::vector<std::pair<int, int>> origin;
+        MPSCQueue<HDABatch> inbox;
+        std::vector<HDABatch*> outbox;
+        SearchStatistics statistics;
+        long messages_sent = 0;
+        bool idle = false;
+
+        Worker(int id, int num_words) : id(id), space(num_words) {}
+    };
+
+    static constexpr uint64_t IDLE = uint64_t(1) << 32;
+
+    BaseTask& planning_task;
+    HeuristicFactory make_heuristic;
+    int num_threads;
+    std::string open_list;
+    int batch_size;
+    std::vector<std::unique_ptr<Worker>> workers;
+    state_hash_t root_hash;
+
+    // (number of idle threads << 32) + number of messages in flight
+    std::atomic<uint64_t> activity{0};
+    std::atomic<bool> done{false};
+    std::atomic<int> incumbent{INF};
+    std::mutex solution_mutex;
+    int solution_thread = -1;
+    int solution_node = -1;
+
+    int owner(state_hash_t hash) const {
+        return (int)(std::hash<state_hash_t>()(hash) % num_threads);
+    }
+
+    void work(Worker& worker) {
+        if (open_list == "bucket" ||
+            (open_list == "auto" && worker.heuristic->integer_valued())) {
+            run<BucketOpenList>(worker);
+        } else {
+            run<HeapOpenList>(worker);
+        }
+    }
+
+    template <typename OpenList>
+    void run(Worker& worker) {
+        OpenList queue;
+        if (worker.id == owner(root_hash)) {
+            StateID root_state_id =
+                worker.space.registry
+                    .insert(planning_task.initial_state, root_hash)
+                    .first;
+            worker.space.add_node(make_root_node(root_state_id));
+            worker.state_cost.push_back(0);
+            worker.origin.emplace_back(-1, -1);
+            float h = worker.heuristic->calculate_h(0, worker.space);
+            worker.statistics.evaluated++;
+            worker.node_h.push_back(h);
+            std::cout << "Initial h value: " << h << "\n";
+            if (planning_task.goal_reached(worker.space.state(0))) {
+                report_goal(worker.id, 0, 0);
+            } else if (h < FLOAT_INF) {
+                queue.push(h, h, 0);
+            }
+        }
+
+        int expansions_since_flush = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            receive(worker, queue);
+            if (!queue.empty()) {
+                expand(worker, queue, queue.pop());
+                // do not keep partial batches from idle threads for long
+                if (++expansions_since_flush >= batch_size) {
+                    flush(worker);
+                    expansions_since_flush = 0;
+                }
+                continue;
+            }
+            flush(worker);
+            if (!worker.idle) {
+                worker.idle = true;
+                activity.fetch_add(IDLE, std::memory_order_acq_rel);
+            }
+            if (activity.load(std::memory_order_acquire) ==
+                num_threads * IDLE) {
+                done.store(true, std::memory_order_release);
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename OpenList>
+    void receive(Worker& worker, OpenList& queue) {
+        int num_words = worker.space.registry.num_words;
+        while (HDABatch* batch = worker.inbox.pop()) {
+            // become busy before the messages stop being in flight
+            if (worker.idle) {
+                worker.idle = false;
+                activity.fetch_sub(IDLE, std::memory_order_acq_rel);
+            }
+            for (size_t i = 0; i < batch->messages.size(); i++) {
+                const HDAMessage& m = batch->messages[i];
+                HashedState state{
+                    StateView(batch->words.data() + i * num_words, num_words),
+                    m.hash};
+                auto [state_id, is_new] = worker.space.registry.insert(state);
+                if (is_new) {
+                    worker.state_cost.push_back(INF);
+                }
+                if (m.g < worker.state_cost[state_id]) {
+                    worker.state_cost[state_id] = m.g;
+                    SearchNode node(state_id, -1, m.action, m.g);
+                    node.unreached = m.unreached;
+                    int node_idx = worker.space.add_node(node);
+                    worker.node_h.push_back(m.h);
+                    worker.origin.emplace_back(batch->sender, m.origin);
+                    queue.push(m.g + m.h, m.h, node_idx);
+                }
+            }
+            activity.fetch_sub(batch->messages.size(),
+                               std::memory_order_acq_rel);
+            delete batch;
+        }
+    }
+
+    template <typename OpenList>
+    void expand(Worker& worker, OpenList& queue, int node_idx) {
+        SearchSpace& space = worker.space;
+        StateID state_id = space[node_idx].state_id;
+        int g = space[node_idx].g;
+        if (worker.state_cost[state_id] != g ||
+            g + worker.node_h[node_idx] >=
+                incumbent.load(std::memory_order_relaxed)) {
+            return;
+        }
+        worker.statistics.expanded++;
+
+        int succ_g = g + 1;
+        planning_task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                worker.statistics.generated++;
+                auto [succ_state_id, is_new] = space.registry.insert(succ);
+                if (is_new) {
+                    worker.state_cost.push_back(INF);
+                }
+                if (succ_g >= worker.state_cost[succ_state_id]) {
+                    return;
+                }
+                worker.state_cost[succ_state_id] = succ_g;
+                int succ_idx = space.add_node(
+                    make_child_node(node_idx, g, succ.action, succ_state_id));
+                worker.origin.emplace_back(-1, -1);
+                if (planning_task.goal_reached(space.state(succ_idx))) {
+                    worker.node_h.push_back(0);
+                    report_goal(worker.id, succ_idx, succ_g);
+                    return;
+                }
+                float h = worker.heuristic->calculate_h(succ_idx, space);
+                worker.statistics.evaluated++;
+                worker.node_h.push_back(h);
+                if (h >= FLOAT_INF ||
+                    succ_g + h >= incumbent.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                int dest = owner(succ.hash);
+                if (dest == worker.id) {
+                    queue.push(succ_g + h, h, succ_idx);
+                } else {
+                    send(worker, dest,
+                         HDAMessage{succ.hash, succ_g, h, succ.action,
+                                    succ_idx, space[succ_idx].unreached},
+                         space.state(succ_idx));
+                }
+            });
+    }
+
+    void send(Worker& worker, int dest, const HDAMessage& message,
+              const StateView& state) {
+        HDABatch*& batch = worker.outbox[dest];
+        if (batch == nullptr) {
+            batch = new HDABatch();
+            batch->sender = worker.id;
+        }
+        batch->messages.push_back(message);
+        for (int i = 0; i < state.num_words; i++) {
+            batch->words.push_back(state.word(i));
+        }
+        if ((int)batch->messages.size() >= batch_size) {
+            flush(worker, dest);
+        }
+    }
+
+    void flush(Worker& worker, int dest) {
+        HDABatch*& batch = worker.outbox[dest];
+        if (batch != nullptr) {
+            worker.messages_sent += batch->messages.size();
+            // in flight before it can be received
+            activity.fetch_add(batch->messages.size(),
+                               std::memory_order_acq_rel);
+            workers[dest]->inbox.push(batch);
+            batch = nullptr;
+        }
+    }
+
+    void flush(Worker& worker) {
+        for (int dest = 0; dest < num_threads; dest++) {
+            flush(worker, dest);
+        }
+    }
+
+    void report_goal(int thread, int node_idx, int g) {
+        if (g >= incumbent.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(solution_mutex);
+        if (g < incumbent.load(std::memory_order_relaxed)) {
+            incumbent.store(g, std::memory_order_relaxed);
+            solution_thread = thread;
+            solution_node = node_idx;
+        }
+    }
+
+    // Follow the parents of the incumbent across the search spaces
+    std::vector<int> extract_plan() const {
+        std::vector<int> plan;
+        int thread = solution_thread;
+        int node_idx = solution_node;
+        while (true) {
+            const Worker& worker = *workers[thread];
+            const SearchNode& node = worker.space[node_idx];
+            if (node.parent_id != -1) {
+                plan.push_back(node.action);
+                node_idx = node.parent_id;
+            } else if (worker.origin[node_idx].first != -1) {
+                std::tie(thread, node_idx) = worker.origin[node_idx];
+            } else {
+                break;
+            }
+        }
+        std::reverse(plan.begin(), plan.end());
+        return plan;
+    }
+};
+
+/*
+A* on "num_threads" threads, see HDAStar.
+@param make_heuristic: Called once per thread
+*/
+inline std::vector<int> hda_star(BaseTask& planning_task,
+                                 HeuristicFactory make_heuristic,
+                                 int num_threads,
+                                 const std::string& open_list = "auto") {
+    HDAStar search(planning_task, make_heuristic, num_threads, open_list);
+    return search.search();
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+class IDAStar {
+    /*
+    Iterative deepening A* (Korf 1985): depth-first searches bounded by
+    f = g + h, where each iteration raises the bound to the smallest f that
+    exceeded it. The search space only holds the current path: a node, its
+    state and its heuristic payload are removed again when the search
+    backtracks, so memory grows with the solution depth only.
+
+    Successors whose state is on the current path (e.g. reached by the
+    inverse of the parent operator) are pruned by looking them up in the
+    registry of the path. A direct-mapped transposition table additionally
+    remembers the g value with which a state hash was reached during the
+    current iteration; reaching it again with no lower g is pruned. Each
+    entry keeps the packed words of its state, so a hash collision only
+    replaces the entry and never prunes a different state.
+    */
+   public:
+    SearchStatistics statistics;
+
+    /*
+    @param table_bits: The transposition table has 2^table_bits entries (0
+    disables it)
+    */
+    IDAStar(BaseTask& planning_task, Heuristic& heuristic, int table_bits = 16)
+        : planning_task(planning_task),
+          heuristic(heuristic),
+          space(planning_task.initial_state.num_words()),
+          num_words(planning_task.initial_state.num_words()) {
+        if (table_bits > 0) {
+            table.resize(size_t(1) << table_bits);
+            table_words.resize(table.size() * num_words);
+        }
+    }
+
+    // @return An optimal plan for admissible heuristics, empty if none
+    std::vector<int> search() {
+        statistics = SearchStatistics();
+        StateID root_state_id =
+            space.registry
+                .insert(planning_task.initial_state,
+                        planning_task.get_hash(planning_task.initial_state))
+                .first;
+        space.add_node(make_root_node(root_state_id));
+        float h = heuristic.calculate_h(0, space);
+        statistics.evaluated++;
+        std::cout << "Initial h value: " << h << "\n";
+
+        float bound = h;
+        while (bound < FLOAT_INF) {
+            iteration++;
+            SearchStatistics before = statistics;
+            float next_bound = visit(0, h, bound);
+            std::cout << "f-bound " << bound << ": "
+                      << statistics.expanded - before.expanded
+                      << " expanded, " << statistics.generated - before.generated
+                      << " generated\n";
+            if (found) {
+                statistics.print();
+                std::cout << space.committed_bytes() << " Bytes committed\n";
+                return solution;
+            }
+            bound = next_bound;
+        }
+        statistics.print();
+        std::cout << space.committed_bytes() << " Bytes committed" << std::endl;
+        std::cerr << "No solution found" << std::endl;
+        return {};
+    }
+
+   private:
+    struct TableEntry {
+        int g = 0;
+        int iteration = 0;
+    };
+
+    BaseTask& planning_task;
+    Heuristic& heuristic;
+    SearchSpace space;
+    int num_words;
+    std::vector<TableEntry> table;
+    // the state of table entry i is table_words[i * num_words:]
+    std::vector<uint64_t> table_words;
+    int iteration = 0;
+    bool found = false;
+    std::vector<int> solution;
+
+    /*
+    Depth-first search below node "node_idx" (the last node of the path).
+    @return The smallest f value above "bound" of the nodes cut off
+    */
+    float visit(int node_idx, float h, float bound) {
+        int g = space[node_idx].g;
+        if (g + h > bound) {
+            return g + h;
+        }
+        if (planning_task.goal_reached(space.state(node_idx))) {
+            found = true;
+            solution = extract_solution(node_idx, space);
+            return g + h;
+        }
+        statistics.expanded++;
+
+        float next_bound = FLOAT_INF;
+        int succ_g = g + 1;
+        planning_task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                if (found) {
+                    return;
+                }
+                statistics.generated++;
+                if (space.registry.find(succ) != NO_STATE) {
+                    return;
+                }
+                if (!table.empty()) {
+                    size_t slot = std::hash<state_hash_t>()(succ.hash) &
+                                  (table.size() - 1);
+                    TableEntry& entry = table[slot];
+                    uint64_t* words = table_words.data() + slot * num_words;
+                    if (entry.iteration == iteration &&
+                        succ.equals(words, num_words)) {
+                        if (entry.g <= succ_g) {
+                            return;
+                        }
+                    } else {
+                        succ.write(words, num_words);
+                    }
+                    entry = TableEntry{succ_g, iteration};
+                }
+
+                MemoryArena::Marker marker = space.arena.mark();
+                StateID succ_state_id = space.registry.insert(succ).first;
+                int succ_idx = space.add_node(make_child_node(
+                    node_idx, g, succ.action, succ_state_id));
+                float succ_h = heuristic.calculate_h(succ_idx, space);
+                statistics.evaluated++;
+                if (succ_h < FLOAT_INF) {
+                    next_bound =
+                        std::min(next_bound, visit(succ_idx, succ_h, bound));
+                }
+                space.pop_node();
+                space.registry.pop_back();
+                space.arena.rewind(marker);
+            });
+        return next_bound;
+    }
+};
+
+/*
+IDA* with memory linear in the solution depth, see IDAStar.
+*/
+inline std::vector<int> ida_star(BaseTask& planning_task, Heuristic& heuristic,
+                                 int table_bits = 16) {
+    IDAStar search(planning_task, heuristic, table_bits);
+    return search.search();
+}
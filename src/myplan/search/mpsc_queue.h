@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+
+template <typename T>
+class MPSCQueue {
+    /*
+    An unbounded lock-free queue of "T" objects for many producers and a
+    single consumer (the intrusive queue of D. Vyukov). T must provide a
+    member "std::atomic<T*> next". The queue does not own its items.
+
+    "pop" may return nullptr while a concurrent "push" is in progress even
+    though the queue is not empty; the item becomes visible once the push
+    completes.
+    */
+   public:
+    MPSCQueue() : head(&stub), tail(&stub) { stub.next.store(nullptr); }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Can be called by any thread
+    void push(T* item) {
+        item->next.store(nullptr, std::memory_order_relaxed);
+        T* prev = head.exchange(item, std::memory_order_acq_rel);
+        prev->next.store(item, std::memory_order_release);
+    }
+
+    // Must only be called by the consumer
+    T* pop() {
+        T* first = tail;
+        T* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+   private:
+    std::atomic<T*> head;
+    T* tail;
+    T stub;
+};
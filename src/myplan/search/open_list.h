@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+Open lists hold node ids ordered by a (key, tie) pair: "pop" returns a node
+with the smallest key and, among those, the smallest tie. All of them
+provide
+
+    void push(float key, float tie, int node);
+    int pop();
+    bool empty() const;
+    size_t size() const;
+
+so that search algorithms can be instantiated with any of them.
+*/
+
+class HeapOpenList {
+    /*
+    A binary heap. Works with any (also fractional) keys; equal pairs are
+    popped in the order of decreasing node id.
+    */
+   public:
+    void push(float key, float tie, int node) {
+        queue.push({-key, -tie, node});
+    }
+
+    int pop() {
+        int node = std::get<2>(queue.top());
+        queue.pop();
+        return node;
+    }
+
+    bool empty() const { return queue.empty(); }
+    size_t size() const { return queue.size(); }
+
+   private:
+    std::priority_queue<std::tuple<float, float, int>> queue;
+};
+
+class BucketOpenList {
+    /*
+    A two-level bucket queue for small non-negative integer keys and ties:
+    nodes are kept in buckets[key][tie], so push and pop take constant
+    amortized time. Equal pairs are popped last-in first-out.
+    */
+   public:
+    BucketOpenList() : min_key(INT_MAX), num_nodes(0) {}
+
+    void push(float key, float tie, int node) {
+        int k = (int)std::lround(key);
+        int t = (int)std::lround(tie);
+        if (k >= (int)levels.size()) {
+            levels.resize(k + 1);
+        }
+        Level& level = levels[k];
+        if (t >= (int)level.buckets.size()) {
+            level.buckets.resize(t + 1);
+        }
+        level.buckets[t].push_back(node);
+        level.size++;
+        level.min_tie = std::min(level.min_tie, t);
+        min_key = std::min(min_key, k);
+        num_nodes++;
+    }
+
+    int pop() {
+        while (levels[min_key].size == 0) {
+            min_key++;
+        }
+        Level& level = levels[min_key];
+        while (level.buckets[level.min_tie].empty()) {
+            level.min_tie++;
+        }
+        int node = level.buckets[level.min_tie].back();
+        level.buckets[level.min_tie].pop_back();
+        if (--level.size == 0) {
+            level.min_tie = INT_MAX;
+        }
+        if (--num_nodes == 0) {
+            min_key = INT_MAX;
+        }
+        return node;
+    }
+
+    bool empty() const { return num_nodes == 0; }
+    size_t size() const { return num_nodes; }
+
+   private:
+    struct Level {
+        std::vector<std::vector<int>> buckets;
+        int min_tie = INT_MAX;
+        size_t size = 0;
+    };
+    std::vector<Level> levels;
+    int min_key;
+    size_t num_nodes;
+};
+
+class RadixHeapOpenList {
+    /*
+    A radix heap over the 64 bit key (key << 32 | tie) of non-negative
+    integer keys and ties. It requires monotone keys: a pushed key must not
+    be smaller than the last popped one (e.g. A* with a consistent
+    heuristic), which is asserted in debug builds. A pushed pair with the
+    last popped key and a smaller tie is treated as equal to the last
+    popped pair.
+    */
+   public:
+    RadixHeapOpenList() : last(0), num_nodes(0) {}
+
+    void push(float key, float tie, int node) {
+        uint64_t k = ((uint64_t)std::lround(key) << 32) |
+                     (uint32_t)std::lround(tie);
+        assert((k >> 32) >= (last >> 32) && "non-monotone radix heap key");
+        k = std::max(k, last);
+        buckets[bucket_index(k)].emplace_back(k, node);
+        num_nodes++;
+    }
+
+    int pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+            // redistribute the bucket with the new minimum into lower ones
+            uint64_t new_last = buckets[i][0].first;
+            for (auto& entry : buckets[i]) {
+                new_last = std::min(new_last, entry.first);
+            }
+            last = new_last;
+            for (auto& entry : buckets[i]) {
+                buckets[bucket_index(entry.first)].push_back(entry);
+            }
+            buckets[i].clear();
+        }
+        int node = buckets[0].back().second;
+        buckets[0].pop_back();
+        num_nodes--;
+        return node;
+    }
+
+    bool empty() const { return num_nodes == 0; }
+    size_t size() const { return num_nodes; }
+
+   private:
+    std::vector<std::pair<uint64_t, int>> buckets[65];
+    uint64_t last;
+    size_t num_nodes;
+
+    int bucket_index(uint64_t k) const {
+        return k == last ? 0 : 64 - __builtin_clzll(k ^ last);
+    }
+};
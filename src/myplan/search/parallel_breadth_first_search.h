@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../task.h"
+#include "state_registry.h"
+
+class ShardedStateRegistry {
+    /*
+    A closed set that many threads can insert into at once. States are
+    partitioned by (the high bits of) their hash into shards, each a
+    StateRegistry guarded by its own mutex, so threads only contend when
+    they insert into the same shard.
+    */
+   public:
+    static const int SHARD_BITS = 6;
+
+    explicit ShardedStateRegistry(int num_words) {
+        for (int i = 0; i < (1 << SHARD_BITS); i++) {
+            shards.push_back(std::make_unique<Shard>(num_words));
+        }
+    }
+
+    // @return True if "state" had not been registered yet
+    template <typename S>
+    bool insert(const S& state) {
+        Shard& shard = *shards[std::hash<state_hash_t>()(state.hash) >>
+                               (64 - SHARD_BITS)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.registry.insert(state).second;
+    }
+
+    int size() const {
+        int n = 0;
+        for (auto& shard : shards) {
+            n += shard->registry.size();
+        }
+        return n;
+    }
+
+    size_t committed_bytes() const {
+        size_t bytes = 0;
+        for (auto& shard : shards) {
+            bytes += shard->registry.committed_bytes();
+        }
+        return bytes;
+    }
+
+   private:
+    struct Shard {
+        std::mutex mutex;
+        StateRegistry registry;
+        explicit Shard(int num_words) : registry(num_words) {}
+    };
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+class LayerBarrier {
+    /*
+    A reusable barrier for a fixed number of threads: arrive_and_wait
+    returns once all of them have arrived, after which the barrier can be
+    used again.
+    */
+   public:
+    explicit LayerBarrier(int num_threads) : num_threads(num_threads) {}
+
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        long arrival_generation = generation;
+        if (++waiting == num_threads) {
+            waiting = 0;
+            generation++;
+            condition.notify_all();
+        } else {
+            condition.wait(lock,
+                           [&]() { return generation != arrival_generation; });
+        }
+    }
+
+   private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    int num_threads;
+    int waiting = 0;
+    long generation = 0;
+};
+
+/*
+Breadth-first search that expands each layer in parallel. The nodes of a
+layer are handed out to "num_threads" threads in chunks through a shared
+cursor, so threads that finish early take over the remaining work. New
+states are deduplicated in a ShardedStateRegistry; every thread collects
+the nodes it generates and the layers are joined when all threads are done.
+The worker threads are started once and meet the calling thread at a
+LayerBarrier before and after every layer they help with.
+Every layer keeps the parent index and action of its nodes, while only the
+states of the current and next layer are stored outside of the registry.
+@param chunk_size: The number of nodes a thread takes at once; layers with
+fewer than two chunks are expanded by the calling thread
+@return A shortest plan
+*/
+inline std::vector<int> parallel_breadth_first_search(BaseTask& planning_task,
+                                                      int num_threads,
+                                                      size_t chunk_size = 64) {
+    // nodes of one layer: parents index into the previous layer
+    struct Layer {
+        std::vector<int> parents;
+        std::vector<int> actions;
+        std::vector<uint64_t> words;
+        std::vector<state_hash_t> hashes;
+
+        size_t size() const { return hashes.size(); }
+        void append(const Layer& other) {
+            parents.insert(parents.end(), other.parents.begin(),
+                           other.parents.end());
+            actions.insert(actions.end(), other.actions.begin(),
+                           other.actions.end());
+            words.insert(words.end(), other.words.begin(), other.words.end());
+            hashes.insert(hashes.end(), other.hashes.begin(),
+                          other.hashes.end());
+        }
+    };
+    num_threads = std::max(num_threads, 1);
+    int num_words = planning_task.initial_state.num_words();
+    ShardedStateRegistry registry(num_words);
+    state_hash_t root_hash =
+        planning_task.get_hash(planning_task.initial_state);
+    registry.insert(HashedState{planning_task.initial_state, root_hash});
+
+    Layer frontier;
+    frontier.parents.push_back(-1);
+    frontier.actions.push_back(-1);
+    frontier.words.assign(planning_task.initial_state.words.begin(),
+                          planning_task.initial_state.words.end());
+    frontier.hashes.push_back(root_hash);
+    // parents and actions of all layers
+    std::vector<std::vector<int>> layer_parents, layer_actions;
+    std::atomic<long> expanded{0};
+
+    // the layer and index of a goal node
+    int goal_layer = -1, goal_node = -1;
+    if (planning_task.goal_reached(planning_task.initial_state)) {
+        goal_layer = 0;
+        goal_node = 0;
+    }
+    layer_parents.push_back(std::move(frontier.parents));
+    layer_actions.push_back(std::move(frontier.actions));
+
+    // per layer: the nodes generated by each thread and the index of the
+    // first goal among them
+    std::vector<Layer> next(num_threads);
+    std::vector<int> goals(num_threads, -1);
+    std::atomic<size_t> cursor{0};
+    std::atomic<bool> goal_found{false};
+    // the number of threads expanding the current layer, 0 to stop
+    int layer_threads = 0;
+
+    auto expand_layer = [&](int thread) {
+        Layer& out = next[thread];
+        long count = 0;
+        while (!goal_found.load(std::memory_order_relaxed)) {
+            size_t begin = cursor.fetch_add(chunk_size);
+            if (begin >= frontier.size()) {
+                break;
+            }
+            size_t end = std::min(begin + chunk_size, frontier.size());
+            for (size_t i = begin; i < end; i++) {
+                StateView state(frontier.words.data() + i * num_words,
+                                num_words);
+                count++;
+                planning_task.for_each_successor(
+                    state, frontier.hashes[i], [&](const Successor& succ) {
+                        if (!registry.insert(succ)) {
+                            return;
+                        }
+                        out.parents.push_back((int)i);
+                        out.actions.push_back(succ.action);
+                        size_t offset = out.words.size();
+                        out.words.resize(offset + num_words);
+                        succ.write(out.words.data() + offset, num_words);
+                        out.hashes.push_back(succ.hash);
+                        if (goals[thread] == -1 &&
+                            planning_task.goal_reached(StateView(
+                                out.words.data() + offset, num_words))) {
+                            goals[thread] = (int)out.size() - 1;
+                            goal_found.store(true);
+                        }
+                    });
+            }
+        }
+        expanded += count;
+    };
+
+    LayerBarrier start_layer(num_threads), end_layer(num_threads);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < num_threads; t++) {
+        workers.emplace_back([&, t]() {
+            while (true) {
+                start_layer.arrive_and_wait();
+                if (layer_threads == 0) {
+                    return;
+                }
+                if (t < layer_threads) {
+                    expand_layer(t);
+                }
+                end_layer.arrive_and_wait();
+            }
+        });
+    }
+
+    while (goal_layer == -1 && frontier.size() > 0) {
+        cursor = 0;
+        goal_found = false;
+        std::fill(goals.begin(), goals.end(), -1);
+
+        // small layers are not worth waking the workers
+        layer_threads =
+            (int)std::min<size_t>(num_threads, frontier.size() / chunk_size);
+        if (layer_threads <= 1) {
+            expand_layer(0);
+        } else {
+            start_layer.arrive_and_wait();
+            expand_layer(0);
+            end_layer.arrive_and_wait();
+        }
+
+        frontier = Layer();
+        for (int t = 0; t < num_threads; t++) {
+            if (goal_node == -1 && goals[t] != -1) {
+                goal_node = (int)frontier.size() + goals[t];
+            }
+            frontier.append(next[t]);
+            next[t] = Layer();
+        }
+        layer_parents.push_back(std::move(frontier.parents));
+        layer_actions.push_back(std::move(frontier.actions));
+        if (goal_node != -1) {
+            goal_layer = (int)layer_parents.size() - 1;
+        }
+    }
+    layer_threads = 0;
+    if (!workers.empty()) {
+        start_layer.arrive_and_wait();
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::cout << expanded << " Nodes expanded" << std::endl;
+    std::cout << registry.size() << " States registered" << std::endl;
+    std::cout << registry.committed_bytes() << " Bytes committed"
+              << std::endl;
+    if (goal_layer == -1) {
+        std::cerr << "No solution found" << std::endl;
+        return {};
+    }
+    std::vector<int> solution;
+    for (int layer = goal_layer, node = goal_node; layer > 0; layer--) {
+        solution.push_back(layer_actions[layer][node]);
+        node = layer_parents[layer][node];
+    }
+    std::reverse(solution.begin(), solution.end());
+    return solution;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../task.h"
+
+// Runs one search on the given task and returns its plan (empty if none)
+typedef std::function<std::vector<int>(BaseTask&)> PortfolioSearchFunction;
+
+struct PortfolioEntry {
+    std::string name;
+    PortfolioSearchFunction run;
+    // in seconds, no limit if <= 0
+    double time_slice = 0;
+};
+
+struct PortfolioResult {
+    std::string name;
+    // "solved", "failed" (no plan), "cancelled" or "timeout"
+    std::string status = "failed";
+    long expanded = 0;
+    long generated = 0;
+    double elapsed_ms = 0;
+    std::vector<int> solution;
+};
+
+class PortfolioTaskView : public BaseTask {
+    /*
+    The view of a shared task given to one search of a portfolio. Successor
+    generation and goal tests are forwarded to the shared task, which is
+    never modified; only the initial state, the goals and the Zobrist table
+    are copied. Once the portfolio is cancelled or the time slice is over,
+    states have no successors and are no goals, so any search empties its
+    open list and returns without a plan soon.
+    */
+   public:
+    std::atomic<long> expanded{0};
+    std::atomic<long> generated{0};
+
+    PortfolioTaskView(BaseTask& task, const std::atomic<bool>& cancelled,
+                      double time_slice)
+        : task(task),
+          cancelled(cancelled),
+          time_slice_ms(time_slice * 1000) {
+        name = task.name;
+        initial_state = task.initial_state;
+        goals = task.goals;
+        zobrist = task.zobrist;
+    }
+
+    // true if the search was stopped because its time slice is over
+    bool timed_out() const { return timeout.load(std::memory_order_relaxed); }
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    bool goal_reached(const StateView& state) override {
+        return !stopped() && task.goal_reached(state);
+    }
+
+    void get_successor_states(
+        const StateView& state,
+        std::vector<std::pair<int, pair<state_hash_t, State>>>& successors,
+        state_hash_t hash_val) override {
+        if (!stopped()) {
+            task.get_successor_states(state, successors, hash_val);
+        }
+    }
+
+    void for_each_successor(const StateView& state, state_hash_t hash_val,
+                            SuccessorCallback callback) override {
+        if (stopped()) {
+            return;
+        }
+        long count = 0;
+        task.for_each_successor(state, hash_val, [&](const Successor& succ) {
+            count++;
+            callback(succ);
+        });
+        expanded.fetch_add(1, std::memory_order_relaxed);
+        generated.fetch_add(count, std::memory_order_relaxed);
+    }
+
+   private:
+    BaseTask& task;
+    const std::atomic<bool>& cancelled;
+    double time_slice_ms;
+    std::atomic<bool> timeout{false};
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    bool stopped() {
+        if (cancelled.load(std::memory_order_relaxed) || timed_out()) {
+            return true;
+        }
+        if (time_slice_ms > 0 && elapsed_ms() >= time_slice_ms) {
+            timeout.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+};
+
+class Portfolio {
+    /*
+    Runs several searches concurrently, one thread each, on views of one
+    shared task (see PortfolioTaskView). The first search that finds a plan
+    cancels the others. Searches that use several threads themselves (e.g.
+    hash-distributed A*) are supported, since they are stopped the same way.
+    */
+   public:
+    std::vector<PortfolioResult> results;
+
+    explicit Portfolio(std::vector<PortfolioEntry> entries)
+        : entries(std::move(entries)) {}
+
+    // @return The plan of the first search that found one, empty if none
+    std::vector<int> search(BaseTask& planning_task) {
+        cancelled = false;
+        winner = -1;
+        results.assign(entries.size(), PortfolioResult());
+        std::vector<std::exception_ptr> errors(entries.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < entries.size(); i++) {
+            threads.emplace_back([&, i]() {
+                try {
+                    run(planning_task, i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    cancelled = true;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        print();
+        if (winner == -1) {
+            std::cerr << "No solution found" << std::endl;
+            return {};
+        }
+        return results[winner].solution;
+    }
+
+    void print() const {
+        printf("%-24s %-10s %12s %12s %12s\n", "configuration", "status",
+               "expanded", "generated", "time [ms]");
+        for (const PortfolioResult& result : results) {
+            printf("%-24s %-10s %12ld %12ld %12.1f\n", result.name.c_str(),
+                   result.status.c_str(), result.expanded, result.generated,
+                   result.elapsed_ms);
+        }
+        if (winner != -1) {
+            printf("Plan found by %s\n", results[winner].name.c_str());
+        }
+    }
+
+   private:
+    std::vector<PortfolioEntry> entries;
+    std::atomic<bool> cancelled{false};
+    std::mutex winner_mutex;
+    int winner = -1;
+
+    void run(BaseTask& planning_task, size_t i) {
+        PortfolioTaskView view(planning_task, cancelled,
+                               entries[i].time_slice);
+        std::vector<int> solution = entries[i].run(view);
+        // an empty plan only solves tasks whose initial state is a goal
+        bool solved = !solution.empty() ||
+                      planning_task.goal_reached(planning_task.initial_state);
+
+        PortfolioResult& result = results[i];
+        result.name = entries[i].name;
+        result.expanded = view.expanded;
+        result.generated = view.generated;
+        result.elapsed_ms = view.elapsed_ms();
+        std::lock_guard<std::mutex> lock(winner_mutex);
+        if (solved && winner == -1) {
+            winner = (int)i;
+            cancelled = true;
+            result.status = "solved";
+            result.solution = std::move(solution);
+        } else if (view.timed_out()) {
+            result.status = "timeout";
+        } else if (cancelled) {
+            result.status = "cancelled";
+        }
+    }
+};
+
+// Run "entries" concurrently, see Portfolio
+inline std::vector<int> portfolio_search(BaseTask& planning_task,
+                                         std::vector<PortfolioEntry> entries) {
+    Portfolio portfolio(std::move(entries));
+    return portfolio.search(planning_task);
+}
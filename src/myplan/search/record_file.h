@@ -0,0 +1,231 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// I/O is done in blocks of this size (a multiple of the O_DIRECT alignment)
+const size_t RECORD_FILE_BLOCK_BYTES = size_t(1) << 20;
+const size_t RECORD_FILE_ALIGNMENT = 4096;
+
+class RecordFile {
+    /*
+    Common part of RecordWriter and RecordReader: a file descriptor and an
+    aligned block buffer. With "direct_io" the file is opened with O_DIRECT
+    (bypassing the page cache) where the platform and file system support
+    it, and with buffered I/O otherwise.
+    */
+   public:
+    RecordFile(const RecordFile&) = delete;
+    RecordFile& operator=(const RecordFile&) = delete;
+
+    const std::string& path() const { return file_path; }
+    size_t record_bytes() const { return record_size; }
+    // Bytes transferred from or to the device so far
+    size_t io_bytes() const { return transferred; }
+    bool uses_direct_io() const { return direct; }
+
+   protected:
+    std::string file_path;
+    size_t record_size;
+    int fd = -1;
+    bool direct = false;
+    char* buffer = nullptr;
+    size_t transferred = 0;
+
+    RecordFile(const std::string& path, size_t record_size, int flags,
+               bool direct_io)
+        : file_path(path), record_size(record_size) {
+#ifdef O_DIRECT
+        if (direct_io) {
+            fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct = fd >= 0;
+        }
+#endif
+        if (fd < 0) {
+            fd = ::open(path.c_str(), flags, 0644);
+        }
+        if (fd < 0) {
+            fail("cannot open");
+        }
+        buffer = (char*)std::aligned_alloc(RECORD_FILE_ALIGNMENT,
+                                           RECORD_FILE_BLOCK_BYTES);
+        if (buffer == nullptr) {
+            ::close(fd);
+            throw std::bad_alloc();
+        }
+    }
+
+    ~RecordFile() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        std::free(buffer);
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(what + " " + file_path + ": " +
+                                 std::strerror(errno));
+    }
+};
+
+class RecordWriter : public RecordFile {
+    /*
+    Appends fixed-size records to a new file in large sequential writes.
+    */
+   public:
+    RecordWriter(const std::string& path, size_t record_size,
+                 bool direct_io = false)
+        : RecordFile(path, record_size, O_WRONLY | O_CREAT | O_TRUNC,
+                     direct_io) {}
+
+    ~RecordWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    void write(const void* record) {
+        const char* src = (const char*)record;
+        size_t remaining = record_size;
+        while (remaining > 0) {
+            size_t n = std::min(remaining, RECORD_FILE_BLOCK_BYTES - filled);
+            std::memcpy(buffer + filled, src, n);
+            filled += n;
+            src += n;
+            remaining -= n;
+            if (filled == RECORD_FILE_BLOCK_BYTES) {
+                flush(RECORD_FILE_BLOCK_BYTES);
+            }
+        }
+        num_records++;
+    }
+
+    size_t size() const { return num_records; }
+
+    // Write the buffered records; called by the destructor as well
+    void close() {
+        if (fd < 0) {
+            return;
+        }
+        size_t logical = transferred + filled;
+        if (filled > 0) {
+            // direct writes must cover whole aligned blocks
+            size_t bytes = filled;
+            if (direct) {
+                bytes = (filled + RECORD_FILE_ALIGNMENT - 1) /
+                        RECORD_FILE_ALIGNMENT * RECORD_FILE_ALIGNMENT;
+                std::memset(buffer + filled, 0, bytes - filled);
+            }
+            flush(bytes);
+            if (direct && ::ftruncate(fd, (off_t)logical) != 0) {
+                fail("cannot truncate");
+            }
+            transferred = logical;
+        }
+        int result = ::close(fd);
+        fd = -1;
+        if (result != 0) {
+            fail("cannot close");
+        }
+    }
+
+   private:
+    size_t filled = 0;
+    size_t num_records = 0;
+
+    void flush(size_t bytes) {
+        size_t done = 0;
+        while (done < bytes) {
+            ssize_t n = ::write(fd, buffer + done, bytes - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("cannot write");
+            }
+            done += n;
+        }
+        transferred += bytes;
+        filled = 0;
+    }
+};
+
+class RecordReader : public RecordFile {
+    /*
+    Reads the records of a file sequentially:
+
+        for (RecordReader r(path, size); !r.done(); r.next()) {
+            use(r.current());
+        }
+    */
+   public:
+    RecordReader(const std::string& path, size_t record_size,
+                 bool direct_io = false)
+        : RecordFile(path, record_size, O_RDONLY, direct_io),
+          scratch(record_size) {
+        next();
+    }
+
+    bool done() const { return at_end; }
+
+    // The current record; valid until the next call of "next"
+    const void* current() const { return record; }
+
+    void next() {
+        if (pos + record_size <= filled) {
+            record = buffer + pos;
+            pos += record_size;
+            return;
+        }
+        // the record continues in the next block
+        size_t copied = 0;
+        while (copied < record_size) {
+            if (pos == filled && !refill()) {
+                at_end = true;
+                return;
+            }
+            size_t n = std::min(record_size - copied, filled - pos);
+            std::memcpy(scratch.data() + copied, buffer + pos, n);
+            copied += n;
+            pos += n;
+        }
+        record = scratch.data();
+    }
+
+   private:
+    std::vector<char> scratch;
+    const char* record = nullptr;
+    size_t pos = 0;
+    size_t filled = 0;
+    bool eof = false;
+    bool at_end = false;
+
+    bool refill() {
+        if (eof) {
+            return false;
+        }
+        ssize_t n;
+        do {
+            n = ::read(fd, buffer, RECORD_FILE_BLOCK_BYTES);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            fail("cannot read");
+        }
+        transferred += n;
+        pos = 0;
+        filled = n;
+        eof = n == 0;
+        return n > 0;
+    }
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+
+struct SearchStatistics {
+    /*
+    Counters reported at the end of a search.
+    */
+    int expanded = 0;
+    int evaluated = 0;
+    int generated = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    void print() const {
+        std::cout << expanded << " Nodes expanded\n";
+        std::cout << evaluated << " Nodes evaluated\n";
+        std::cout << generated << " Nodes generated\n";
+        std::cout << "Search wall time " << elapsed_ms() << " [ms]\n";
+    }
+};
@@ -11,41 +11,74 @@
 #include <vector>
 
 #include "../parallel_hashmap/phmap.h"
+#include "../state.h"
+#include "../zobrist.h"
+#include "arena.h"
+#include "state_registry.h"
 
 using phmap::flat_hash_map;
 using phmap::flat_hash_set;
 
-inline size_t hash_unordered_set(const flat_hash_set<int>& ss) {
-    size_t seed = 0;
-    for (int x : ss) {
-        seed ^= std::hash<std::string>{}(std::to_string(x));
-    }
-    return seed;
-}
-
 class SearchNode {
    public:
     // Constructo
     // SearchNode() {}
-    SearchNode(flat_hash_set<int>& state, int parent_id, int action, int g,
-               size_t hash_value)
-        : state(state),
-          parent_id(parent_id),
-          action(action),
-          g(g),
-          hash_value(hash_value) {}
-
-    flat_hash_set<int> state;
-    flat_hash_set<int> unreached;
+    SearchNode(StateID state_id, int parent_id, int action, int g)
+        : state_id(state_id), parent_id(parent_id), action(action), g(g) {}
+
+    StateID state_id;
     int parent_id;
     int action;
     int g;
-    size_t hash_value;
+    // per-node data of path dependent heuristics (allocated from the arena)
+    const uint64_t* unreached = nullptr;
+};
+
+class SearchSpace {
+    /*
+    All nodes generated by a search together with the registry that stores
+    their states. Nodes only hold the id of their state and are kept in
+    fixed-size segments, so adding nodes never copies the existing ones.
+    Additional per-node payloads are allocated from "arena".
+    */
+   public:
+    StateRegistry registry;
+    SegmentedVector<SearchNode> nodes;
+    MemoryArena arena;
+
+    explicit SearchSpace(int num_words) : registry(num_words) {}
+
+    SearchNode& operator[](int node_id) { return nodes[node_id]; }
+    const SearchNode& operator[](int node_id) const { return nodes[node_id]; }
+
+    int size() const { return (int)nodes.size(); }
+
+    int add_node(const SearchNode& node) {
+        nodes.push_back(node);
+        return (int)nodes.size() - 1;
+    }
+
+    // Remove the most recently added node
+    void pop_node() { nodes.pop_back(); }
+
+    StateView state(int node_id) const {
+        return registry.lookup(nodes[node_id].state_id);
+    }
+
+    state_hash_t hash(int node_id) const {
+        return registry.hash(nodes[node_id].state_id);
+    }
+
+    // Bytes obtained from the system for nodes, states and payloads
+    size_t committed_bytes() const {
+        return registry.committed_bytes() + nodes.committed_bytes() +
+               arena.committed_bytes();
+    }
 };
 
 // Extract the solution from the search space
-inline std::vector<int> extract_solution(int this_id,
-                                         std::vector<SearchNode>& nodes) {
+template <typename NodeContainer>
+inline std::vector<int> extract_solution(int this_id, NodeContainer& nodes) {
     int node_id = this_id;
     std::vector<int> solution;
     while (nodes[node_id].parent_id != -1) {
@@ -58,15 +91,12 @@ inline std::vector<int> extract_solution(int this_id,
 }
 
 // Construct an initial search node
-inline SearchNode make_root_node(flat_hash_set<int>& initial_state) {
-    return SearchNode(initial_state, -1, -1, 0,
-                      hash_unordered_set(initial_state));
+inline SearchNode make_root_node(StateID state_id) {
+    return SearchNode(state_id, -1, -1, 0);
 }
 
 // Construct a new search node linked to a parent node
 inline SearchNode make_child_node(int parent_id, int parent_g, int action,
-                                  flat_hash_set<int>& state,
-                                  size_t hash_val) {
-    return SearchNode(state, parent_id, action, parent_g + 1, hash_val);
+                                  StateID state_id) {
+    return SearchNode(state_id, parent_id, action, parent_g + 1);
 }
-
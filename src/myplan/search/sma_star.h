@@ -0,0 +1,622 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../parallel_hashmap/phmap.h"
+#include "../task.h"
+#include "search_statistics.h"
+#include "searchspace.h"
+
+struct SMANode {
+    int parent;
+    int action;
+    int g;
+    float h;
+    // f value, raised to the f values of forgotten descendants
+    float f;
+    // the children in memory as a doubly linked list, -1 at the ends
+    int first_child;
+    int next_sibling;
+    int prev_sibling;
+    // the forgotten children as a list of SMAForgotten, -1 at the end
+    int first_forgotten;
+    // position among the successors of the parent
+    int index;
+    // bit i: successor i cannot reach the goal within the budget
+    uint64_t dead;
+    // key in the open list, -1 if the node is not queued
+    float open_f;
+    state_hash_t hash;
+};
+
+// The f value of a forgotten child, kept by a parent with children
+struct SMAForgotten {
+    float f;
+    int index;
+    int next;
+};
+
+class SMAStar {
+    /*
+    Memory-bounded A* in the style of SMA* (Russell 1992). Nodes live in a
+    pool that is reserved once for the largest number of nodes that fits
+    into the byte budget, with a free list for released slots. The touched
+    part of the pool, the state table, the open list, the leaves and the
+    records of forgotten children are counted against the budget. When it
+    is full, the worst leaf (highest f, shallowest) is forgotten and its f
+    value is backed up into its parent: a parent with other children keeps
+    a small record of it and is queued with the best such value, to
+    regenerate that child alone; a parent without children becomes a leaf
+    with the best value of its forgotten children. Children inherit the f
+    value of their parent if it is larger (pathmax).
+
+    Successors whose state is on the path to the expanded node are pruned,
+    and so are successors whose state is held by a node in memory with no
+    higher g value (found through a table keyed by state hash): that node,
+    or the record of it in its parent once it is forgotten, covers the
+    successor's subtree. A duplicate that is not in memory any more is
+    generated again.
+
+    A node at the maximum depth, whose children cannot fit next to its
+    path, gets an infinite f value unless it is a goal, so the search
+    continues elsewhere instead of exceeding the budget; if it then fails,
+    it reports that the budget was too small.
+    Nodes with an infinite f value are released, and the first 64
+    successors of a node remember this in a bitmask, so a re-expansion does
+    not generate them again. If the budget runs out while a node is
+    expanded, its remaining successors are recorded as forgotten children
+    with the f value of the node.
+
+    The heuristic is evaluated in a scratch SearchSpace holding the parent
+    and the child; per-node payloads of path dependent heuristics are copied
+    into the pool (see Heuristic::node_payload_words).
+    */
+   public:
+    SearchStatistics statistics;
+    long forgotten = 0;
+    // true if a part of the search space did not fit into the budget; a
+    // plan found then is not proven to be optimal
+    bool out_of_memory = false;
+    // bytes of the scratch space, which are not available to the node pool
+    size_t fixed_bytes = 0;
+
+    /*
+    @param memory_bytes: Budget for the node pool, the records of forgotten
+    children, the open list, the leaves and the scratch space
+    */
+    SMAStar(BaseTask& planning_task, Heuristic& heuristic, size_t memory_bytes)
+        : planning_task(planning_task),
+          heuristic(heuristic),
+          num_words(planning_task.initial_state.num_words()),
+          payload_words(heuristic.node_payload_words()),
+          memory_bytes(memory_bytes),
+          scratch(num_words) {}
+
+    SMAStar(const SMAStar&) = delete;
+    SMAStar& operator=(const SMAStar&) = delete;
+
+    // Bytes per node in the pool, the open list and the leaves, without the
+    // state table
+    size_t node_bytes() const { return slot_bytes() + 2 * SET_ENTRY_BYTES; }
+
+    std::vector<int> search() {
+        statistics = SearchStatistics();
+        const State& init = planning_task.initial_state;
+        state_hash_t root_hash = planning_task.get_hash(init);
+        scratch.add_node(
+            make_root_node(scratch.registry.insert(init, root_hash).first));
+        float h = heuristic.calculate_h(0, scratch);
+        statistics.evaluated++;
+        std::cout << "Initial h value: " << h << "\n";
+
+        fixed_bytes = scratch.committed_bytes();
+        pool_bytes = memory_bytes > fixed_bytes ? memory_bytes - fixed_bytes : 0;
+        // the most nodes that fit next to a state table for all of them
+        size_t low = 0, high = pool_bytes / node_bytes();
+        while (low < high) {
+            size_t n = (low + high + 1) / 2;
+            if (n * node_bytes() + table_bytes(n) <= pool_bytes) {
+                low = n;
+            } else {
+                high = n - 1;
+            }
+        }
+        max_nodes = low;
+        std::cout << max_nodes << " Nodes fit into the memory budget\n";
+        if (max_nodes < 2) {
+            out_of_memory = true;
+            return finish({});
+        }
+        nodes.reserve(max_nodes);
+        words.reserve(max_nodes * num_words);
+        payloads.reserve(max_nodes * payload_words);
+        free_list.reserve(max_nodes);
+        table.rehash(table_capacity(max_nodes));
+        int root = allocate();
+        nodes[root] = make_node(-1, -1, 0, 0, root_hash);
+        nodes[root].h = nodes[root].f = h;
+        std::copy(init.words.begin(), init.words.end(), state_words(root));
+        copy_payload(root, scratch[0].unreached);
+        table[root_hash] = root;
+        leaves.insert(leaf_key(root));
+        enqueue(root);
+
+        while (!open.empty() && std::get<0>(*open.begin()) < FLOAT_INF) {
+            int node = std::get<2>(*open.begin());
+            dequeue(node);
+            if (nodes[node].first_child != -1) {
+                regenerate(node);
+                continue;
+            }
+            if (planning_task.goal_reached(state(node))) {
+                std::vector<int> plan;
+                for (int n = node; nodes[n].parent != -1; n = nodes[n].parent) {
+                    plan.push_back(nodes[n].action);
+                }
+                std::reverse(plan.begin(), plan.end());
+                return finish(plan);
+            }
+            leaves.erase(leaf_key(node));
+            expand(node);
+        }
+        return finish({});
+    }
+
+   private:
+    // size of a std::set node: its value and the red-black tree links,
+    // plus the header of the allocation, rounded up to the 16 byte
+    // granularity of malloc
+    static const size_t SET_ENTRY_BYTES =
+        (sizeof(std::tuple<float, int, int>) + 5 * sizeof(void*) + 15) / 16 *
+        16;
+    // a slot of the state table and its control byte
+    static const size_t TABLE_ENTRY_BYTES =
+        sizeof(std::pair<state_hash_t, int>) + 1;
+
+    BaseTask& planning_task;
+    Heuristic& heuristic;
+    int num_words;
+    int payload_words;
+    size_t memory_bytes;
+    size_t pool_bytes = 0;
+    // the longest path that fits into the pool
+    size_t max_nodes = 0;
+
+    std::vector<SMANode> nodes;
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> payloads;
+    std::vector<int> free_list;
+    // records of forgotten children, allocated in chunks so that they never
+    // need twice their size while growing
+    std::deque<SMAForgotten> records;
+    std::deque<int> free_records;
+    // a node in memory for each state hash, the one with the lowest g
+    phmap::flat_hash_map<state_hash_t, int> table;
+    // nodes to expand by (f, -g): leaves by their f value and parents by
+    // the best f value of their forgotten children
+    std::set<std::tuple<float, int, int>> open;
+    // the leaves by (f, -g), the last one is forgotten first
+    std::set<std::tuple<float, int, int>> leaves;
+    // holds the initial state and, temporarily, a parent and a child
+    SearchSpace scratch;
+    // a successor at the maximum depth, for the goal test
+    std::vector<uint64_t> buffer;
+
+    uint64_t* state_words(int id) {
+        return words.data() + (size_t)id * num_words;
+    }
+    const uint64_t* state_words(int id) const {
+        return words.data() + (size_t)id * num_words;
+    }
+    StateView state(int id) const { return StateView(state_words(id), num_words); }
+    uint64_t* payload(int id) {
+        return payloads.data() + (size_t)id * payload_words;
+    }
+
+    static SMANode make_node(int parent, int action, int g, int index,
+                             state_hash_t hash) {
+        return SMANode{parent, action, g,  0, 0,   -1, -1, -1, -1,
+                       index,  0,      -1, hash};
+    }
+
+    std::vector<int> finish(const std::vector<int>& plan) {
+        statistics.print();
+        std::cout << forgotten << " Nodes forgotten\n";
+        std::cout << committed_bytes() << " Bytes committed" << std::endl;
+        if (plan.empty() &&
+            !planning_task.goal_reached(planning_task.initial_state)) {
+            std::cerr << (out_of_memory ? "Memory budget exhausted"
+                                        : "No solution found")
+                      << std::endl;
+        }
+        if (!plan.empty() && out_of_memory) {
+            std::cout << "The plan is not proven to be optimal: the memory "
+                         "budget was exhausted"
+                      << std::endl;
+        }
+        return plan;
+    }
+
+    size_t committed_bytes() const { return fixed_bytes + used_bytes(); }
+
+    // Bytes of a slot in the pool and the free list
+    size_t slot_bytes() const {
+        return sizeof(SMANode) + (num_words + payload_words) * sizeof(uint64_t) +
+               sizeof(int);
+    }
+
+    // Bytes used by the containers of the search, which are only touched
+    // up to their size
+    size_t used_bytes() const {
+        return nodes.size() * slot_bytes() +
+               table.capacity() * TABLE_ENTRY_BYTES +
+               (open.size() + leaves.size()) * SET_ENTRY_BYTES +
+               records.size() * sizeof(SMAForgotten) +
+               free_records.size() * sizeof(int);
+    }
+
+    /*
+    The capacity of a state table for "n" nodes. It is one less than a
+    power of two, and the table is rehashed in place instead of growing as
+    long as it holds at most half of the 7/8 of its slots it may fill.
+    */
+    static size_t table_capacity(size_t n) {
+        size_t capacity = 15;
+        while ((capacity - capacity / 8) / 2 < n) {
+            capacity = 2 * capacity + 1;
+        }
+        return capacity;
+    }
+
+    static size_t table_bytes(size_t n) {
+        return table_capacity(n) * TABLE_ENTRY_BYTES;
+    }
+
+    // Bytes needed to add one more node
+    size_t new_node_bytes() const {
+        return (free_list.empty() ? slot_bytes() : 0) + 2 * SET_ENTRY_BYTES;
+    }
+
+    int allocate() {
+        int id;
+        if (!free_list.empty()) {
+            id = free_list.back();
+            free_list.pop_back();
+        } else {
+            // the pool has been reserved for "max_nodes"
+            id = (int)nodes.size();
+            nodes.emplace_back();
+            words.resize(words.size() + num_words);
+            payloads.resize(payloads.size() + payload_words);
+        }
+        return id;
+    }
+
+    void link(int child) {
+        SMANode& parent = nodes[nodes[child].parent];
+        nodes[child].prev_sibling = -1;
+        nodes[child].next_sibling = parent.first_child;
+        if (parent.first_child != -1) {
+            nodes[parent.first_child].prev_sibling = child;
+        }
+        parent.first_child = child;
+    }
+
+    // Unlink a node from its parent and free its slot
+    void release(int id) {
+        SMANode& node = nodes[id];
+        auto entry = table.find(node.hash);
+        if (entry != table.end() && entry->second == id) {
+            table.erase(entry);
+        }
+        if (node.prev_sibling != -1) {
+            nodes[node.prev_sibling].next_sibling = node.next_sibling;
+        } else {
+            nodes[node.parent].first_child = node.next_sibling;
+        }
+        if (node.next_sibling != -1) {
+            nodes[node.next_sibling].prev_sibling = node.prev_sibling;
+        }
+        free_list.push_back(id);
+    }
+
+    void add_record(int id, float f, int index) {
+        int record;
+        if (!free_records.empty()) {
+            record = free_records.back();
+            free_records.pop_back();
+        } else {
+            record = (int)records.size();
+            records.emplace_back();
+        }
+        records[record] = SMAForgotten{f, index, nodes[id].first_forgotten};
+        nodes[id].first_forgotten = record;
+    }
+
+    // The best f value of the forgotten children of a node
+    float forgotten_f(int id) const {
+        float f = FLOAT_INF;
+        for (int r = nodes[id].first_forgotten; r != -1; r = records[r].next) {
+            f = std::min(f, records[r].f);
+        }
+        return f;
+    }
+
+    // Remove the best record of a forgotten child and return it
+    SMAForgotten pop_record(int id) {
+        int* best = &nodes[id].first_forgotten;
+        for (int* r = best; *r != -1; r = &records[*r].next) {
+            if (records[*r].f < records[*best].f) {
+                best = r;
+            }
+        }
+        int record = *best;
+        *best = records[record].next;
+        free_records.push_back(record);
+        return records[record];
+    }
+
+    void clear_records(int id) {
+        for (int r = nodes[id].first_forgotten; r != -1; r = records[r].next) {
+            free_records.push_back(r);
+        }
+        nodes[id].first_forgotten = -1;
+    }
+
+    void copy_payload(int id, const uint64_t* data) {
+        if (payload_words > 0 && data != nullptr) {
+            std::copy(data, data + payload_words, payload(id));
+        }
+    }
+
+    std::tuple<float, int, int> leaf_key(int id) const {
+        return std::make_tuple(nodes[id].f, -nodes[id].g, id);
+    }
+
+    // Queue a node if it is a leaf or has forgotten children
+    void enqueue(int id) {
+        SMANode& node = nodes[id];
+        float key = node.first_child == -1 ? node.f : forgotten_f(id);
+        if (key < FLOAT_INF) {
+            node.open_f = key;
+            open.emplace(key, -node.g, id);
+        }
+    }
+
+    void dequeue(int id) {
+        SMANode& node = nodes[id];
+        if (node.open_f >= 0) {
+            open.erase(std::make_tuple(node.open_f, -node.g, id));
+            node.open_f = -1;
+        }
+    }
+
+    void mark_dead(int id, int index) {
+        if (index < 64) {
+            nodes[id].dead |= uint64_t(1) << index;
+        }
+    }
+
+    /*
+    A node without children becomes a leaf with the f value of its
+    forgotten children. If it has no finite f value left, it is released
+    as well and its parent may become a leaf in turn.
+    */
+    void became_leaf(int id) {
+        while (true) {
+            SMANode& node = nodes[id];
+            node.f = std::max(node.f, forgotten_f(id));
+            clear_records(id);
+            if (node.f < FLOAT_INF || node.parent == -1) {
+                leaves.insert(leaf_key(id));
+                enqueue(id);
+                return;
+            }
+            int parent = node.parent;
+            mark_dead(parent, node.index);
+            release(id);
+            if (nodes[parent].first_child != -1) {
+                return;
+            }
+            id = parent;
+            dequeue(id);
+        }
+    }
+
+    // Forget leaves until a node can be added; false if that is impossible
+    bool make_room(int expanding) {
+        while (used_bytes() + new_node_bytes() > pool_bytes ||
+               (free_list.empty() && nodes.size() >= max_nodes)) {
+            if (leaves.empty()) {
+                return false;
+            }
+            int worst = std::get<2>(*leaves.rbegin());
+            if (nodes[worst].parent == -1) {
+                return false;
+            }
+            leaves.erase(std::prev(leaves.end()));
+            dequeue(worst);
+            int parent = nodes[worst].parent;
+            add_record(parent, nodes[worst].f, nodes[worst].index);
+            release(worst);
+            forgotten++;
+            if (parent == expanding) {
+                continue;
+            }
+            dequeue(parent);
+            if (nodes[parent].first_child != -1) {
+                enqueue(parent);
+            } else {
+                became_leaf(parent);
+            }
+        }
+        return true;
+    }
+
+    bool on_path(int id, const Successor& succ) const {
+        for (; id != -1; id = nodes[id].parent) {
+            if (succ.hash == nodes[id].hash &&
+                succ.equals(state_words(id), num_words)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // True if a node in memory holds the state of "succ" with a g value of
+    // at most "succ_g"
+    bool dominated(const Successor& succ, int succ_g) const {
+        auto entry = table.find(succ.hash);
+        return entry != table.end() && nodes[entry->second].g <= succ_g &&
+               succ.equals(state_words(entry->second), num_words);
+    }
+
+    // Make "id" the node of its state in the table unless a node with
+    // another state or a lower g value is there
+    void register_state(int id) {
+        auto inserted = table.emplace(nodes[id].hash, id);
+        int other = inserted.first->second;
+        if (!inserted.second && nodes[other].g > nodes[id].g &&
+            std::equal(state_words(id), state_words(id) + num_words,
+                       state_words(other))) {
+            inserted.first->second = id;
+        }
+    }
+
+    bool is_goal(const Successor& succ) {
+        buffer.resize(num_words);
+        succ.write(buffer.data(), num_words);
+        return planning_task.goal_reached(StateView(buffer.data(), num_words));
+    }
+
+    float evaluate(int child) {
+        int parent = nodes[child].parent;
+        int registered = scratch.registry.size();
+        MemoryArena::Marker marker = scratch.arena.mark();
+        SearchNode parent_node(
+            scratch.registry.insert(state(parent), nodes[parent].hash).first,
+            0, nodes[parent].action, nodes[parent].g);
+        parent_node.unreached = payload_words > 0 ? payload(parent) : nullptr;
+        int parent_idx = scratch.add_node(parent_node);
+        int child_idx = scratch.add_node(make_child_node(
+            parent_idx, nodes[parent].g, nodes[child].action,
+            scratch.registry.insert(state(child), nodes[child].hash).first));
+        float h = heuristic.calculate_h(child_idx, scratch);
+        statistics.evaluated++;
+        copy_payload(child, scratch[child_idx].unreached);
+        scratch.pop_node();
+        scratch.pop_node();
+        while (scratch.registry.size() > registered) {
+            scratch.registry.pop_back();
+        }
+        scratch.arena.rewind(marker);
+        return h;
+    }
+
+    /*
+    Add the successor "succ" of "node" as a child whose f value is at least
+    "min_f". False if it does not fit next to the path, which is not
+    expected below the maximum depth.
+    */
+    bool generate(int node, const Successor& succ, int succ_index,
+                  float min_f) {
+        statistics.generated++;
+        int succ_g = nodes[node].g + 1;
+        if (on_path(node, succ)) {
+            mark_dead(node, succ_index);
+            return true;
+        }
+        if (dominated(succ, succ_g)) {
+            return true;
+        }
+        if ((size_t)succ_g + 1 >= max_nodes && !is_goal(succ)) {
+            mark_dead(node, succ_index);
+            out_of_memory = true;
+            return true;
+        }
+        if (!make_room(node)) {
+            out_of_memory = true;
+            return false;
+        }
+        int child = allocate();
+        nodes[child] =
+            make_node(node, succ.action, succ_g, succ_index, succ.hash);
+        succ.write(state_words(child), num_words);
+        float h = evaluate(child);
+        if (h >= FLOAT_INF) {
+            mark_dead(node, succ_index);
+            free_list.push_back(child);
+            return true;
+        }
+        nodes[child].h = h;
+        nodes[child].f = std::max(succ_g + h, min_f);
+        link(child);
+        register_state(child);
+        leaves.insert(leaf_key(child));
+        enqueue(child);
+        return true;
+    }
+
+    // The node has no children in memory any more, or some of them
+    void finish_expansion(int node) {
+        if (nodes[node].first_child == -1) {
+            // a dead end, at the maximum depth, or all children forgotten
+            became_leaf(node);
+        } else {
+            enqueue(node);
+        }
+    }
+
+    void expand(int node) {
+        statistics.expanded++;
+        float node_f = nodes[node].f;
+        bool truncated = false;
+        int index = 0;
+        planning_task.for_each_successor(
+            state(node), nodes[node].hash, [&](const Successor& succ) {
+                int succ_index = index++;
+                if (succ_index < 64 && (nodes[node].dead >> succ_index) & 1) {
+                    return;
+                }
+                if (!truncated) {
+                    truncated = !generate(node, succ, succ_index, node_f);
+                    if (!truncated) {
+                        return;
+                    }
+                }
+                // no room left: regenerate the successor later
+                add_record(node, node_f, succ_index);
+            });
+        finish_expansion(node);
+    }
+
+    // Generate the best forgotten child of a node with children
+    void regenerate(int node) {
+        SMAForgotten record = pop_record(node);
+        int index = 0;
+        planning_task.for_each_successor(
+            state(node), nodes[node].hash, [&](const Successor& succ) {
+                if (index++ == record.index &&
+                    !generate(node, succ, record.index, record.f)) {
+                    add_record(node, record.f, record.index);
+                }
+            });
+        finish_expansion(node);
+    }
+};
+
+/*
+A* within a memory budget of "memory_bytes", see SMAStar.
+*/
+inline std::vector<int> sma_star(BaseTask& planning_task, Heuristic& heuristic,
+                                 size_t memory_bytes) {
+    SMAStar search(planning_task, heuristic, memory_bytes);
+    return search.search();
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../parallel_hashmap/phmap.h"
+#include "../state.h"
+#include "../zobrist.h"
+#include "arena.h"
+
+typedef int StateID;
+
+const StateID NO_STATE = -1;
+
+// A complete state with its hash, in the form StateRegistry stores states
+struct HashedState {
+    StateView state;
+    state_hash_t hash;
+
+    bool equals(const uint64_t* words, int num_words) const {
+        for (int i = 0; i < num_words; i++) {
+            if (words[i] != state.word(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void write(uint64_t* words, int num_words) const {
+        for (int i = 0; i < num_words; i++) {
+            words[i] = state.word(i);
+        }
+    }
+};
+
+class StateRegistry {
+    /*
+    Interns every distinct state once. The packed words of all registered
+    states are kept back to back in arena segments (so registering a state
+    never moves the others) and a state is identified by its index
+    (StateID). States with equal hashes are told apart by a full
+    comparison of their words, so hash collisions never merge two states.
+
+    Besides HashedState, states can be given in any form "S" that provides
+    the member "hash" and the methods "equals(words, num_words)" and
+    "write(words, num_words)" (e.g. Successor). Such a state is only written
+    to the registry if it is new.
+    */
+    struct IDHash {
+        using is_transparent = void;
+        const StateRegistry* registry;
+        size_t operator()(StateID id) const {
+            return std::hash<state_hash_t>()(registry->hashes[id]);
+        }
+        template <typename S>
+        size_t operator()(const S& state) const {
+            return std::hash<state_hash_t>()(state.hash);
+        }
+    };
+
+    struct IDEqual {
+        using is_transparent = void;
+        const StateRegistry* registry;
+        bool operator()(StateID a, StateID b) const {
+            return (registry->hashes[a] == registry->hashes[b]) &&
+                   std::memcmp(registry->data(a), registry->data(b),
+                               registry->num_words * sizeof(uint64_t)) == 0;
+        }
+        template <typename S>
+        bool operator()(const S& state, StateID id) const {
+            return (state.hash == registry->hashes[id]) &&
+                   state.equals(registry->data(id), registry->num_words);
+        }
+        template <typename S>
+        bool operator()(StateID id, const S& state) const {
+            return (*this)(state, id);
+        }
+    };
+
+   public:
+    int num_words;
+
+    explicit StateRegistry(int num_words)
+        : num_words(num_words),
+          state_data(num_words),
+          ids(0, IDHash{this}, IDEqual{this}) {}
+
+    // The hash and equality functors point back to the registry.
+    StateRegistry(const StateRegistry&) = delete;
+    StateRegistry& operator=(const StateRegistry&) = delete;
+
+    int size() const { return (int)hashes.size(); }
+
+    /*
+    Register "state" whose hash is "hash_value" (equal states must have
+    equal hashes).
+    @return The id of the state and true if it had not been registered yet
+    */
+    std::pair<StateID, bool> insert(const StateView& state,
+                                    state_hash_t hash_value) {
+        return insert(HashedState{state, hash_value});
+    }
+
+    template <typename S>
+    std::pair<StateID, bool> insert(const S& state) {
+        bool is_new = false;
+        auto it = ids.lazy_emplace(state, [&](const auto& construct) {
+            is_new = true;
+            construct(push_back(state));
+        });
+        return std::make_pair(*it, is_new);
+    }
+
+    /*
+    Remove the most recently registered state, so that the registry can
+    hold the states of a search path (see IDAStar).
+    */
+    void pop_back() {
+        ids.erase(size() - 1);
+        state_data.pop_back();
+        hashes.pop_back();
+    }
+
+    // @return The id of "state" or NO_STATE if it has not been registered
+    StateID find(const StateView& state, state_hash_t hash_value) const {
+        return find(HashedState{state, hash_value});
+    }
+
+    template <typename S>
+    StateID find(const S& state) const {
+        auto it = ids.find(state);
+        return it == ids.end() ? NO_STATE : *it;
+    }
+
+    StateView lookup(StateID id) const { return StateView(data(id), num_words); }
+
+    state_hash_t hash(StateID id) const { return hashes[id]; }
+
+    // Bytes obtained from the system for the states and the id set
+    size_t committed_bytes() const {
+        return state_data.committed_bytes() + hashes.committed_bytes() +
+               ids.capacity() * (sizeof(StateID) + 1);
+    }
+
+   private:
+    SegmentedArrayVector<uint64_t> state_data;
+    SegmentedVector<state_hash_t> hashes;
+    phmap::flat_hash_set<StateID, IDHash, IDEqual> ids;
+
+    const uint64_t* data(StateID id) const { return state_data[id]; }
+
+    template <typename S>
+    StateID push_back(const S& state) {
+        StateID id = (StateID)hashes.size();
+        state.write(state_data.push_back(), num_words);
+        hashes.push_back(state.hash);
+        return id;
+    }
+};
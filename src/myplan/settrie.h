@@ -37,7 +37,15 @@ class SetTrie {
         }
     }
 
-    //~SetTrie() { destroy(root); }
+    SetTrie(const SetTrie& other) : root(clone(other.root)) {}
+    SetTrie(SetTrie&& other) : root(other.root) { other.root = nullptr; }
+
+    SetTrie& operator=(SetTrie other) {
+        std::swap(root, other.root);
+        return *this;
+    }
+
+    ~SetTrie() { destroy(root); }
 
     void assign(std::set<KeyType> keyset, ValueType value) {
         int valcnt = 0;
@@ -57,14 +65,24 @@ class SetTrie {
    private:
     Node* root;
 
-    /*
     void destroy(Node* node) {
+        if (node == nullptr) {
+            return;
+        }
         for (auto child : node->children) {
             destroy(child);
         }
         delete node;
     }
-    */
+
+    Node* clone(const Node* node) {
+        Node* copy = new Node(node->data, node->values);
+        copy->flag_last = node->flag_last;
+        for (Node* child : node->children) {
+            copy->children.push_back(clone(child));
+        }
+        return copy;
+    }
 
     void assignHelper(Node* node, typename std::set<KeyType>::const_iterator it,
                       typename std::set<KeyType>::const_iterator end,
@@ -110,3 +128,137 @@ class SetTrie {
         // path.pop_back();
     }
 };
+
+template <typename KeyType, typename ValueType>
+class FlatSetTrie {
+    /*
+    A SetTrie whose nodes live in one contiguous pool. The children of a
+    node occupy a contiguous range of the pool sorted by key, so a query
+    finds the matching children by binary search in the (sorted) query
+    instead of chasing pointers.
+    The trie is built in bulk: "assign" only records the key set and the
+    pool is rebuilt before the next query.
+    */
+   public:
+    struct Node {
+        KeyType data;
+        int children_begin;
+        int children_end;
+        int values_begin;
+        int values_end;
+    };
+
+    FlatSetTrie() : dirty(false) {}
+
+    FlatSetTrie(std::vector<std::pair<std::set<KeyType>, std::vector<ValueType>>>
+                    iterable)
+        : dirty(true) {
+        for (const auto& pair : iterable) {
+            for (const ValueType& value : pair.second) {
+                items.emplace_back(
+                    std::vector<KeyType>(pair.first.begin(), pair.first.end()),
+                    value);
+            }
+        }
+        build();
+    }
+
+    void assign(std::set<KeyType> keyset, ValueType value) {
+        items.emplace_back(std::vector<KeyType>(keyset.begin(), keyset.end()),
+                           value);
+        dirty = true;
+    }
+
+    std::vector<ValueType> subsets(std::set<KeyType>& keyset) {
+        std::vector<ValueType> result;
+        subsets(keyset, result);
+        return result;
+    }
+
+    void subsets(std::set<KeyType>& keyset, std::vector<ValueType>& result) {
+        if (dirty) {
+            build();
+        }
+        query.assign(keyset.begin(), keyset.end());
+        subsetsHelper(0, 0, result);
+    }
+
+    int num_nodes() {
+        if (dirty) {
+            build();
+        }
+        return (int)nodes.size();
+    }
+
+   private:
+    std::vector<Node> nodes;
+    std::vector<ValueType> values;
+    // (sorted key set, value) in assignment order
+    std::vector<std::pair<std::vector<KeyType>, ValueType>> items;
+    std::vector<KeyType> query;
+    bool dirty;
+
+    void build() {
+        // sort the key sets once; equal key sets keep their assignment order
+        std::vector<int> order(items.size());
+        for (int i = 0; i < (int)items.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return items[a].first < items[b].first;
+        });
+        nodes.clear();
+        values.clear();
+        nodes.push_back(Node{KeyType(), 0, 0, 0, 0});
+        buildHelper(0, order, 0, (int)order.size(), 0);
+        dirty = false;
+    }
+
+    // the key sets order[lo:hi] share their first "depth" keys
+    void buildHelper(int node, const std::vector<int>& order, int lo, int hi,
+                     int depth) {
+        nodes[node].values_begin = (int)values.size();
+        while (lo < hi && (int)items[order[lo]].first.size() == depth) {
+            values.push_back(items[order[lo]].second);
+            lo++;
+        }
+        nodes[node].values_end = (int)values.size();
+
+        // allocate all children first so that they are contiguous
+        std::vector<std::pair<int, int>> ranges;
+        int begin = (int)nodes.size();
+        for (int i = lo; i < hi;) {
+            const KeyType& key = items[order[i]].first[depth];
+            int j = i;
+            while (j < hi && items[order[j]].first[depth] == key) {
+                j++;
+            }
+            nodes.push_back(Node{key, 0, 0, 0, 0});
+            ranges.emplace_back(i, j);
+            i = j;
+        }
+        nodes[node].children_begin = begin;
+        nodes[node].children_end = (int)nodes.size();
+        for (int c = 0; c < (int)ranges.size(); c++) {
+            buildHelper(begin + c, order, ranges[c].first, ranges[c].second,
+                        depth + 1);
+        }
+    }
+
+    // only query keys from position "pos" onwards can extend the path
+    void subsetsHelper(int node, int pos, std::vector<ValueType>& result) {
+        result.insert(result.end(), values.begin() + nodes[node].values_begin,
+                      values.begin() + nodes[node].values_end);
+        auto it = query.begin() + pos;
+        for (int c = nodes[node].children_begin; c < nodes[node].children_end;
+             c++) {
+            it = std::lower_bound(it, query.end(), nodes[c].data);
+            if (it == query.end()) {
+                break;
+            }
+            if (*it == nodes[c].data) {
+                subsetsHelper(c, (int)(it - query.begin()) + 1, result);
+            }
+        }
+    }
+};
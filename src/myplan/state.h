@@ -0,0 +1,265 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+#include "parallel_hashmap/phmap.h"
+
+using phmap::flat_hash_set;
+
+const int BITS_PER_WORD = 64;
+
+inline int num_words_for(int num_facts) {
+    return (num_facts + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+// A set of bits restricted to a single word of a packed state.
+struct WordMask {
+    int word;
+    uint64_t bits;
+
+    bool operator==(const WordMask& other) const {
+        return (word == other.word) && (bits == other.bits);
+    }
+};
+
+// Group the given fact ids into one mask per touched word (sorted by word).
+inline std::vector<WordMask> make_word_masks(const std::vector<int>& facts) {
+    std::vector<WordMask> masks;
+    for (int fact : facts) {
+        int word = fact / BITS_PER_WORD;
+        uint64_t bit = uint64_t(1) << (fact % BITS_PER_WORD);
+        auto it = masks.begin();
+        while (it != masks.end() && it->word < word) {
+            it++;
+        }
+        if (it != masks.end() && it->word == word) {
+            it->bits |= bit;
+        } else {
+            masks.insert(it, {word, bit});
+        }
+    }
+    return masks;
+}
+
+class StateIterator {
+    /*
+    Iterates over the ids of the true facts of a packed state.
+    */
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = int;
+
+    StateIterator(const uint64_t* words, int num_words, int word_idx)
+        : words(words), num_words(num_words), word_idx(word_idx), cur(0) {
+        if (word_idx < num_words) {
+            cur = words[word_idx];
+            skip_empty_words();
+        }
+    }
+
+    int operator*() const {
+        return word_idx * BITS_PER_WORD + __builtin_ctzll(cur);
+    }
+
+    StateIterator& operator++() {
+        cur &= cur - 1;
+        skip_empty_words();
+        return *this;
+    }
+
+    bool operator==(const StateIterator& other) const {
+        return (word_idx == other.word_idx) && (cur == other.cur);
+    }
+    bool operator!=(const StateIterator& other) const {
+        return !(*this == other);
+    }
+
+   private:
+    const uint64_t* words;
+    int num_words;
+    int word_idx;
+    uint64_t cur;
+
+    void skip_empty_words() {
+        while (cur == 0 && ++word_idx < num_words) {
+            cur = words[word_idx];
+        }
+    }
+};
+
+class StateView {
+    /*
+    A read-only view of a packed state that is owned elsewhere (a State or
+    the storage of a StateRegistry).
+    Words beyond num_words are treated as zero.
+    */
+   public:
+    const uint64_t* words;
+    int num_words;
+
+    StateView() : words(nullptr), num_words(0) {}
+    StateView(const uint64_t* words, int num_words)
+        : words(words), num_words(num_words) {}
+
+    uint64_t word(int i) const { return i < num_words ? words[i] : 0; }
+
+    bool contains(int fact) const {
+        return (word(fact / BITS_PER_WORD) >> (fact % BITS_PER_WORD)) & 1;
+    }
+
+    int size() const {
+        int cnt = 0;
+        for (int i = 0; i < num_words; i++) {
+            cnt += __builtin_popcountll(words[i]);
+        }
+        return cnt;
+    }
+
+    bool empty() const {
+        for (int i = 0; i < num_words; i++) {
+            if (words[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool contains_all(const std::vector<WordMask>& masks) const {
+        for (const WordMask& m : masks) {
+            if ((word(m.word) & m.bits) != m.bits) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // @return True if every fact of this state is also true in "other"
+    bool is_subset_of(const StateView& other) const {
+        for (int i = 0; i < num_words; i++) {
+            if (words[i] & ~other.word(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Number of facts of this state that are false in "other"
+    int count_missing_in(const StateView& other) const {
+        int cnt = 0;
+        for (int i = 0; i < num_words; i++) {
+            cnt += __builtin_popcountll(words[i] & ~other.word(i));
+        }
+        return cnt;
+    }
+
+    bool operator==(const StateView& other) const {
+        int n = std::max(num_words, other.num_words);
+        for (int i = 0; i < n; i++) {
+            if (word(i) != other.word(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const StateView& other) const { return !(*this == other); }
+
+    StateIterator begin() const { return StateIterator(words, num_words, 0); }
+    StateIterator end() const {
+        return StateIterator(words, num_words, num_words);
+    }
+};
+
+class State {
+    /*
+    A STRIPS state packed as a fixed-width bitset over dense fact ids.
+    Fact f is true iff bit (f % 64) of words[f / 64] is set.
+    */
+   public:
+    std::vector<uint64_t> words;
+
+    typedef StateIterator const_iterator;
+
+    State() {}
+    explicit State(int num_facts) : words(num_words_for(num_facts), 0) {}
+    State(std::initializer_list<int> facts) {
+        for (int f : facts) {
+            insert(f);
+        }
+    }
+    State(const flat_hash_set<int>& facts) {
+        for (int f : facts) {
+            insert(f);
+        }
+    }
+    State(const StateView& view) : words(view.words, view.words + view.num_words) {}
+
+    operator StateView() const { return view(); }
+    StateView view() const { return StateView(words.data(), num_words()); }
+
+    int num_words() const { return (int)words.size(); }
+
+    // Widen (or narrow) the bitset so that it holds exactly num_facts facts.
+    void resize(int num_facts) { words.resize(num_words_for(num_facts), 0); }
+
+    bool contains(int fact) const { return view().contains(fact); }
+    int size() const { return view().size(); }
+    bool empty() const { return view().empty(); }
+    bool contains_all(const std::vector<WordMask>& masks) const {
+        return view().contains_all(masks);
+    }
+    bool is_subset_of(const StateView& other) const {
+        return view().is_subset_of(other);
+    }
+    int count_missing_in(const StateView& other) const {
+        return view().count_missing_in(other);
+    }
+
+    // @return True if the fact was not in the state before
+    bool insert(int fact) {
+        int word = fact / BITS_PER_WORD;
+        if (word >= num_words()) {
+            words.resize(word + 1, 0);
+        }
+        uint64_t bit = uint64_t(1) << (fact % BITS_PER_WORD);
+        bool inserted = !(words[word] & bit);
+        words[word] |= bit;
+        return inserted;
+    }
+
+    // @return True if the fact was in the state before
+    bool erase(int fact) {
+        if (!contains(fact)) {
+            return false;
+        }
+        words[fact / BITS_PER_WORD] &= ~(uint64_t(1) << (fact % BITS_PER_WORD));
+        return true;
+    }
+
+    void set_union(const StateView& other) {
+        if (other.num_words > num_words()) {
+            words.resize(other.num_words, 0);
+        }
+        for (int i = 0; i < other.num_words; i++) {
+            words[i] |= other.words[i];
+        }
+    }
+
+    void set_difference(const StateView& other) {
+        int n = std::min(num_words(), other.num_words);
+        for (int i = 0; i < n; i++) {
+            words[i] &= ~other.words[i];
+        }
+    }
+
+    bool operator==(const State& other) const { return view() == other.view(); }
+    bool operator!=(const State& other) const { return !(*this == other); }
+
+    const_iterator begin() const { return view().begin(); }
+    const_iterator end() const { return view().end(); }
+};
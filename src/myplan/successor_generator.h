@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "state.h"
+
+class SuccessorGenerator {
+    /*
+    A decision tree over fact ids that finds the operators applicable in a
+    state. Every node lists the operators whose preconditions are all
+    tested on the path to it, followed by switches "if fact f is true,
+    descend into child c". The preconditions of an operator are tested in
+    ascending order, so the switches of a node are sorted by fact.
+
+    The tree is stored in flat arrays (CSR style): node n owns the
+    operators ops[node_ops[n]:node_ops[n+1]] and the switches
+    [node_switches[n], node_switches[n+1]) of switch_fact/switch_child.
+    Queries test facts directly against the packed state and need no
+    temporary containers.
+    */
+   public:
+    std::vector<int> node_ops;
+    std::vector<int> node_switches;
+    std::vector<int> ops;
+    std::vector<int> switch_fact;
+    std::vector<int> switch_child;
+
+    SuccessorGenerator() {}
+
+    /*
+    @param preconditions: The precondition facts of each operator. The
+    generator reports operators by their index in this vector.
+    */
+    explicit SuccessorGenerator(
+        const std::vector<std::vector<int>>& preconditions) {
+        std::vector<std::vector<int>> sorted_pre(preconditions);
+        std::vector<std::pair<int, int>> items;
+        for (int i = 0; i < (int)sorted_pre.size(); i++) {
+            std::sort(sorted_pre[i].begin(), sorted_pre[i].end());
+            sorted_pre[i].erase(
+                std::unique(sorted_pre[i].begin(), sorted_pre[i].end()),
+                sorted_pre[i].end());
+            items.emplace_back(i, 0);
+        }
+        std::vector<BuildNode> tree;
+        build(sorted_pre, items, tree);
+        flatten(tree);
+    }
+
+    int num_nodes() const { return (int)node_ops.size() - 1; }
+
+    // Call "callback(op)" for every operator applicable in "state"
+    template <typename Callback>
+    void generate_applicable(const StateView& state, Callback&& callback) const {
+        if (num_nodes() > 0) {
+            visit(0, state, callback);
+        }
+    }
+
+    void get_applicable_operators(const StateView& state,
+                                  std::vector<int>& result) const {
+        generate_applicable(state, [&](int op) { result.push_back(op); });
+    }
+
+   private:
+    struct BuildNode {
+        std::vector<int> ops;
+        std::vector<std::pair<int, int>> switches;
+    };
+
+    // "items" holds (operator, number of preconditions already tested)
+    int build(const std::vector<std::vector<int>>& pre,
+              std::vector<std::pair<int, int>>& items,
+              std::vector<BuildNode>& tree) {
+        int node = (int)tree.size();
+        tree.emplace_back();
+        std::vector<std::pair<int, int>> rest;
+        for (auto& item : items) {
+            if (item.second == (int)pre[item.first].size()) {
+                tree[node].ops.push_back(item.first);
+            } else {
+                rest.push_back(item);
+            }
+        }
+        // group the remaining operators by their next precondition
+        std::stable_sort(rest.begin(), rest.end(),
+                         [&](const std::pair<int, int>& a,
+                             const std::pair<int, int>& b) {
+                             return pre[a.first][a.second] <
+                                    pre[b.first][b.second];
+                         });
+        size_t begin = 0;
+        while (begin < rest.size()) {
+            int fact = pre[rest[begin].first][rest[begin].second];
+            size_t end = begin;
+            std::vector<std::pair<int, int>> group;
+            while (end < rest.size() &&
+                   pre[rest[end].first][rest[end].second] == fact) {
+                group.emplace_back(rest[end].first, rest[end].second + 1);
+                end++;
+            }
+            int child = build(pre, group, tree);
+            tree[node].switches.emplace_back(fact, child);
+            begin = end;
+        }
+        return node;
+    }
+
+    void flatten(const std::vector<BuildNode>& tree) {
+        node_ops.push_back(0);
+        node_switches.push_back(0);
+        for (const BuildNode& node : tree) {
+            ops.insert(ops.end(), node.ops.begin(), node.ops.end());
+            for (auto& sw : node.switches) {
+                switch_fact.push_back(sw.first);
+                switch_child.push_back(sw.second);
+            }
+            node_ops.push_back((int)ops.size());
+            node_switches.push_back((int)switch_fact.size());
+        }
+    }
+
+    template <typename Callback>
+    void visit(int node, const StateView& state, Callback& callback) const {
+        for (int i = node_ops[node]; i < node_ops[node + 1]; i++) {
+            callback(ops[i]);
+        }
+        for (int i = node_switches[node]; i < node_switches[node + 1]; i++) {
+            if (state.contains(switch_fact[i])) {
+                visit(switch_child[i], state, callback);
+            }
+        }
+    }
+};
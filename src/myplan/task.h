@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <any>
 //#include <flat_hash_set>
 #include <functional>
@@ -8,8 +9,12 @@
 #include <string>
 #include <vector>
 
+#include "function_ref.h"
+#include "operator_table.h"
 #include "parallel_hashmap/phmap.h"
-#include "settrie.h"
+#include "state.h"
+#include "successor_generator.h"
+#include "zobrist.h"
 
 using namespace std;
 using phmap::flat_hash_map;
@@ -77,85 +82,72 @@ class Operator {
 };
 
 class EncodedOperator {
+    /*
+    An operator over fact ids. The fact lists are sorted and free of
+    duplicates; Task copies them into its OperatorTable, which search and
+    heuristics read.
+    */
    public:
     int name;
-    set<int> preconditions;
-    set<int> add_effects;
-    set<int> del_effects;
-    vector<int> preconditions_vec;
-    vector<int> add_effects_vec;
-    vector<int> del_effects_vec;
-
-    EncodedOperator(int name, vector<int>& preconditions,
-                    vector<int>& add_effects, vector<int>& del_effects) {
-        this->name = name;
-        this->preconditions_vec = preconditions;
-        this->preconditions =
-            set<int>(preconditions.begin(), preconditions.end());
-        this->add_effects_vec = add_effects;
-        this->add_effects = set<int>(add_effects.begin(), add_effects.end());
-        this->del_effects_vec = del_effects;
-        this->del_effects = set<int>(del_effects.begin(), del_effects.end());
-    }
+    vector<int> preconditions;
+    vector<int> add_effects;
+    vector<int> del_effects;
 
-    EncodedOperator(const Operator& op,
+    EncodedOperator(int name, const vector<int>& preconditions,
+                    const vector<int>& add_effects,
+                    const vector<int>& del_effects)
+        : name(name),
+          preconditions(sorted(preconditions)),
+          add_effects(sorted(add_effects)),
+          del_effects(sorted(del_effects)) {}
+
+    EncodedOperator(const Operator& op, int name,
                     std::unordered_map<std::string, int>& encoding_map) {
-        this->name = encoding_map[op.name];
+        this->name = name;
         for (std::string s : op.preconditions) {
-            preconditions.emplace(encoding_map[s]);
-            preconditions_vec.emplace_back(encoding_map[s]);
+            preconditions.emplace_back(encoding_map[s]);
         }
         for (std::string s : op.add_effects) {
-            add_effects.emplace(encoding_map[s]);
-            add_effects_vec.emplace_back(encoding_map[s]);
+            add_effects.emplace_back(encoding_map[s]);
         }
         for (std::string s : op.del_effects) {
-            del_effects.emplace(encoding_map[s]);
-            del_effects_vec.emplace_back(encoding_map[s]);
+            del_effects.emplace_back(encoding_map[s]);
         }
+        preconditions = sorted(preconditions);
+        add_effects = sorted(add_effects);
+        del_effects = sorted(del_effects);
     }
 
-    bool applicable(const flat_hash_set<int>& state) {
-        for (int p : preconditions) {
-            if (state.find(p) == state.end()) {
-                return false;
+    int max_fact() const {
+        int m = -1;
+        for (const vector<int>* v :
+             {&preconditions, &add_effects, &del_effects}) {
+            for (int f : *v) {
+                m = std::max(m, f);
             }
         }
-        return true;
+        return m;
     }
 
-    pair<size_t, flat_hash_set<int>> apply(const flat_hash_set<int>& state,
-                                           size_t hash_val) {
-        // assert(applicable(state));
-        flat_hash_set<int> new_state = state;
-        for (const int& fact : del_effects) {
-            if (new_state.erase(fact)) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
-        }
-        for (const int& fact : add_effects) {
-            if (new_state.insert(fact).second) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
+    bool applicable(const StateView& state) const {
+        for (int fact : preconditions) {
+            if (!state.contains(fact)) {
+                return false;
             }
         }
-        return make_pair(hash_val, new_state);
+        return true;
     }
 
-    void apply(const flat_hash_set<int>& state,
-               pair<size_t, flat_hash_set<int>>& result, size_t hash_val) {
+    State apply(const StateView& state) const {
         // assert(applicable(state));
-        result.second = state;
-        for (const int fact : del_effects_vec) {
-            if (result.second.erase(fact)) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
+        State new_state(state);
+        for (int fact : del_effects) {
+            new_state.erase(fact);
         }
-        for (const int fact : add_effects_vec) {
-            if (result.second.insert(fact).second) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
+        for (int fact : add_effects) {
+            new_state.insert(fact);
         }
-        result.first = hash_val;
+        return new_state;
     }
 
     bool operator==(const EncodedOperator& other) const {
@@ -163,8 +155,68 @@ class EncodedOperator {
                (add_effects == other.add_effects) &&
                (del_effects == other.del_effects);
     }
+
+   private:
+    static vector<int> sorted(vector<int> facts) {
+        std::sort(facts.begin(), facts.end());
+        facts.erase(std::unique(facts.begin(), facts.end()), facts.end());
+        return facts;
+    }
+};
+
+struct Successor {
+    /*
+    The state reached by applying an operator in "parent", described by
+    the effect masks of the operator without copying "parent". Its words
+    are computed only when it is compared with or copied into a stored
+    state (see StateRegistry::insert), so duplicate successors are never
+    materialized.
+    Without effects, the successor is "parent" itself.
+    */
+    int action;
+    state_hash_t hash;
+    StateView parent;
+    Span<EffectMask> effects;
+
+    bool equals(const uint64_t* words, int num_words) const {
+        int k = 0;
+        for (int i = 0; i < num_words; i++) {
+            if (words[i] != word(i, k)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void write(uint64_t* words, int num_words) const {
+        int k = 0;
+        for (int i = 0; i < num_words; i++) {
+            words[i] = word(i, k);
+        }
+    }
+
+    State state() const {
+        State result;
+        result.words.resize(std::max(
+            parent.num_words, effects.empty() ? 0 : effects.last[-1].word + 1));
+        write(result.words.data(), result.num_words());
+        return result;
+    }
+
+   private:
+    // the i-th word; "k" walks over the effect masks in order
+    uint64_t word(int i, int& k) const {
+        uint64_t w = parent.word(i);
+        if (k < effects.size() && effects[k].word == i) {
+            w = (w & ~effects[k].del) | effects[k].add;
+            k++;
+        }
+        return w;
+    }
 };
 
+typedef FunctionRef<void(const Successor&)> SuccessorCallback;
+
 namespace std {
 template <>
 struct hash<flat_hash_set<std::string>> {
@@ -212,19 +264,42 @@ class BaseTask {
    public:
     std::string name;
     flat_hash_set<int> facts;
-    flat_hash_set<int> initial_state;
-    flat_hash_set<int> goals;
+    State initial_state;
+    State goals;
     std::vector<EncodedOperator> operators;
+    // facts are numbered densely from 0 and operators by their index
     std::unordered_map<std::string, int> encoding_map;
-    std::unordered_map<int, std::string> reverse_encoding_map;
-    std::unordered_map<int, std::string> action_id2name;
+    std::vector<std::string> reverse_encoding_map;
+    std::vector<std::string> action_id2name;
+    ZobristTable zobrist;
 
-    virtual bool goal_reached(flat_hash_set<int>& state) = 0;
+    virtual bool goal_reached(const StateView& state) = 0;
     virtual void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            successors,
-        size_t hash_val) = 0;
+        const StateView& state,
+        std::vector<std::pair<int, pair<state_hash_t, State>>>& successors,
+        state_hash_t hash_val) = 0;
+
+    /*
+    Call "callback" with every successor of "state" as soon as it is
+    generated. A successor is only described (see Successor) and its view
+    is valid during the call only.
+    The default implementation materializes the successors with
+    get_successor_states.
+    */
+    virtual void for_each_successor(const StateView& state,
+                                    state_hash_t hash_val,
+                                    SuccessorCallback callback) {
+        std::vector<std::pair<int, pair<state_hash_t, State>>> successors;
+        get_successor_states(state, successors, hash_val);
+        for (auto& opss : successors) {
+            callback(Successor{opss.first, opss.second.first,
+                               opss.second.second, {}});
+        }
+    }
+
+    state_hash_t get_hash(const StateView& state) const {
+        return zobrist.hash(state);
+    }
 };
 
 class Task : public BaseTask {
@@ -232,61 +307,105 @@ class Task : public BaseTask {
     A STRIPS planning task
     */
    public:
-    SetTrie<int, EncodedOperator*> settrie;
+    OperatorTable operator_table;
+    SuccessorGenerator successor_generator;
+    int num_facts = 0;
 
     Task() {}
     Task(std::string name, flat_hash_set<int>& facts,
-         flat_hash_set<int>& initial_state, flat_hash_set<int>& goals,
-         std::vector<EncodedOperator> operators)
-        : settrie(SetTrie<int, EncodedOperator*>()) {
+         const State& initial_state, const State& goals,
+         std::vector<EncodedOperator> operators) {
         this->name = name;
         this->facts = facts;
         this->initial_state = initial_state;
         this->goals = goals;
         this->operators = operators;
-        initialize_settrie();
+        initialize_num_facts();
+        zobrist = ZobristTable(num_facts);
+        initialize_operator_table();
+        initialize_successor_generator();
     }
 
-    void initialize_settrie() {
+    void initialize_num_facts() {
+        // every state of this task is packed with the same width
+        int max_fact = -1;
+        for (int f : facts) {
+            max_fact = std::max(max_fact, f);
+        }
+        for (int f : initial_state) {
+            max_fact = std::max(max_fact, f);
+        }
+        for (int f : goals) {
+            max_fact = std::max(max_fact, f);
+        }
+        for (EncodedOperator& op : operators) {
+            max_fact = std::max(max_fact, op.max_fact());
+        }
+        num_facts = max_fact + 1;
+        initial_state.resize(num_facts);
+        goals.resize(num_facts);
+    }
+
+    // Must be called again after "operators" changed
+    void initialize_operator_table() {
+        operator_table.clear();
         for (EncodedOperator& op : operators) {
-            settrie.assign(op.preconditions, &op);
+            operator_table.add_operator(op.name, op.preconditions,
+                                        op.add_effects, op.del_effects);
+        }
+    }
+
+    void initialize_successor_generator() {
+        std::vector<std::vector<int>> preconditions;
+        for (int op = 0; op < operator_table.size(); op++) {
+            Span<int> pre = operator_table.pre(op);
+            preconditions.emplace_back(pre.begin(), pre.end());
         }
+        successor_generator = SuccessorGenerator(preconditions);
     }
 
-    bool goal_reached(flat_hash_set<int>& state) override {
+    bool goal_reached(const StateView& state) override {
         /*
         The goal has been reached if all facts that are true in "goals"
         are true in "state".
         @return True if all the goals are reached, False otherwise
         */
-        for (int g : goals) {
-            if (state.find(g) == state.end()) {
-                return false;
-            }
-        }
-        return true;
-        // return state == goals;
+        return goals.is_subset_of(state);
     }
 
     void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            successors,
-        size_t hash_val) override {
+        const StateView& state,
+        std::vector<std::pair<int, pair<state_hash_t, State>>>& successors,
+        state_hash_t hash_val) override {
         /*
         @return A vector with (op, new_state) pairs where "op" is the applicable
         operator and "new_state" the state that results when "op" is applied
         in state "state".
         */
-        std::set<int> sorted_state(state.begin(), state.end());
-        std::vector<EncodedOperator*> applicable_operators;
-        settrie.subsets(sorted_state, applicable_operators);
-        successors.resize(applicable_operators.size());
         size_t i = 0;
-        for (EncodedOperator* op : applicable_operators) {
-            successors[i].first = op->name;
-            op->apply(state, successors[i].second, hash_val);
+        successor_generator.generate_applicable(state, [&](int op) {
+            if (i == successors.size()) {
+                successors.emplace_back();
+            }
+            successors[i].first = operator_table.name(op);
+            successors[i].second.first =
+                operator_table.successor_hash(op, state, hash_val, zobrist);
+            State& new_state = successors[i].second.second;
+            new_state.words.resize(state.num_words);
+            Successor{0, 0, state, operator_table.effect_masks(op)}.write(
+                new_state.words.data(), state.num_words);
             i++;
-        }
+        });
+        successors.resize(i);
+    }
+
+    void for_each_successor(const StateView& state, state_hash_t hash_val,
+                            SuccessorCallback callback) override {
+        successor_generator.generate_applicable(state, [&](int op) {
+            callback(Successor{
+                operator_table.name(op),
+                operator_table.successor_hash(op, state, hash_val, zobrist),
+                state, operator_table.effect_masks(op)});
+        });
     }
 };
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "state.h"
+
+#ifndef MYPLAN_HASH_BITS
+#define MYPLAN_HASH_BITS 64
+#endif
+
+struct hash128_t {
+    uint64_t lo;
+    uint64_t hi;
+
+    hash128_t() : lo(0), hi(0) {}
+    hash128_t(uint64_t lo) : lo(lo), hi(0) {}
+    hash128_t(uint64_t lo, uint64_t hi) : lo(lo), hi(hi) {}
+
+    hash128_t& operator^=(const hash128_t& other) {
+        lo ^= other.lo;
+        hi ^= other.hi;
+        return *this;
+    }
+    bool operator==(const hash128_t& other) const {
+        return (lo == other.lo) && (hi == other.hi);
+    }
+    bool operator!=(const hash128_t& other) const { return !(*this == other); }
+};
+
+namespace std {
+template <>
+struct hash<hash128_t> {
+    size_t operator()(const hash128_t& h) const {
+        return h.lo ^ (h.hi * 0x9e3779b97f4a7c15ULL);
+    }
+};
+}  // namespace std
+
+#if MYPLAN_HASH_BITS == 128
+typedef hash128_t state_hash_t;
+#elif MYPLAN_HASH_BITS == 64
+typedef uint64_t state_hash_t;
+#else
+#error "MYPLAN_HASH_BITS must be 64 or 128"
+#endif
+
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline void draw_zobrist_key(uint64_t& key, uint64_t& seed) {
+    key = splitmix64(seed);
+}
+inline void draw_zobrist_key(hash128_t& key, uint64_t& seed) {
+    key.lo = splitmix64(seed);
+    key.hi = splitmix64(seed);
+}
+
+template <typename HashT>
+class BasicZobristTable {
+    /*
+    One random key per fact. The hash of a state is the XOR of the keys of
+    its true facts, so toggling a fact updates the hash with a single XOR.
+    */
+   public:
+    std::vector<HashT> keys;
+
+    BasicZobristTable() {}
+    explicit BasicZobristTable(int num_facts,
+                               uint64_t seed = 0x5eed5eed5eed5eedULL)
+        : keys(num_facts) {
+        for (HashT& key : keys) {
+            draw_zobrist_key(key, seed);
+        }
+    }
+
+    int size() const { return (int)keys.size(); }
+
+    const HashT& key(int fact) const { return keys[fact]; }
+
+    HashT hash(const StateView& state) const {
+        HashT h = HashT();
+        for (int fact : state) {
+            h ^= keys[fact];
+        }
+        return h;
+    }
+};
+
+typedef BasicZobristTable<state_hash_t> ZobristTable;
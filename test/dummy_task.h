@@ -11,11 +11,12 @@ class DummyTask : public BaseTask {
         this->name = name;
         this->initial_state = initial_state;
         this->goals = goals;
+        this->zobrist = ZobristTable(32);
     }
 
-    bool goal_reached(flat_hash_set<int>& state) override {
+    bool goal_reached(const StateView& state) override {
         for (int g : goals) {
-            if (state.find(g) == state.end()) {
+            if (!state.contains(g)) {
                 return false;
             }
         }
@@ -23,10 +24,9 @@ class DummyTask : public BaseTask {
     }
 
     void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            succesors,
-        size_t hash_val) override {
+        const StateView& state,
+        std::vector<std::pair<int, pair<state_hash_t, State>>>& succesors,
+        state_hash_t) override {
         std::vector<int> emp_vec;
         EncodedOperator* sub1 =
             new EncodedOperator(0, emp_vec, emp_vec, emp_vec);
@@ -36,19 +36,19 @@ class DummyTask : public BaseTask {
             new EncodedOperator(1, emp_vec, emp_vec, emp_vec);
         for (int s : state) {
             if (0 < s) {
-                flat_hash_set<int> tmp_u = {s - 1};
-                succesors.push_back(
-                    std::make_pair(sub1->name, make_pair(s - 1, tmp_u)));
+                State tmp_u = {s - 1};
+                succesors.push_back(std::make_pair(
+                    sub1->name, make_pair(zobrist.hash(tmp_u), tmp_u)));
             }
             if (s < 9) {
-                flat_hash_set<int> tmp_u = {s + 2};
-                succesors.push_back(
-                    std::make_pair(add2->name, make_pair(s + 2, tmp_u)));
+                State tmp_u = {s + 2};
+                succesors.push_back(std::make_pair(
+                    add2->name, make_pair(zobrist.hash(tmp_u), tmp_u)));
             }
             if (s < 10) {
-                flat_hash_set<int> tmp_u = {s + 1};
-                succesors.push_back(
-                    std::make_pair(add1->name, make_pair(s + 1, tmp_u)));
+                State tmp_u = {s + 1};
+                succesors.push_back(std::make_pair(
+                    add1->name, make_pair(zobrist.hash(tmp_u), tmp_u)));
             }
         }
     }
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "myplan/search/arena.h"
+
+TEST(MemoryArena, BumpAllocation) {
+    MemoryArena arena(1024);
+    ASSERT_EQ(arena.committed_bytes(), 0);
+    uint64_t* a = arena.allocate_array<uint64_t>(4);
+    uint64_t* b = arena.allocate_array<uint64_t>(4);
+    ASSERT_EQ(b, a + 4);
+    ASSERT_EQ((uintptr_t)a % alignof(uint64_t), 0);
+    ASSERT_EQ(arena.committed_bytes(), 1024);
+    ASSERT_EQ(arena.used_bytes(), 64);
+    // requests larger than a chunk get a chunk of their own
+    arena.allocate(4096);
+    ASSERT_GE(arena.committed_bytes(), 1024 + 4096);
+}
+
+TEST(MemoryArena, RewindReusesMemory) {
+    MemoryArena arena(1024);
+    arena.allocate_array<uint64_t>(4);
+    MemoryArena::Marker marker = arena.mark();
+    uint64_t* b = arena.allocate_array<uint64_t>(4);
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(512);
+    }
+    size_t committed = arena.committed_bytes();
+    arena.rewind(marker);
+    ASSERT_EQ(arena.used_bytes(), 32);
+    ASSERT_EQ(arena.allocate_array<uint64_t>(4), b);
+    // the released chunks are handed out again
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(512);
+    }
+    ASSERT_EQ(arena.committed_bytes(), committed);
+}
+
+TEST(SegmentedVector, AddressesAreStable) {
+    SegmentedVector<int> v;
+    v.push_back(0);
+    int* first = &v[0];
+    for (int i = 1; i < 1000000; i++) {
+        v.push_back(i);
+    }
+    ASSERT_EQ(first, &v[0]);
+    ASSERT_EQ(v.size(), 1000000);
+    ASSERT_EQ(v[123456], 123456);
+    v.pop_back();
+    ASSERT_EQ(v.size(), 999999);
+    ASSERT_GT(v.committed_bytes(), 999999 * sizeof(int));
+}
+
+TEST(SegmentedArrayVector, FixedWidthEntries) {
+    SegmentedArrayVector<uint64_t> v(3, 64);
+    for (uint64_t i = 0; i < 10; i++) {
+        uint64_t* entry = v.push_back();
+        entry[0] = i;
+        entry[1] = i * 2;
+        entry[2] = i * 3;
+    }
+    ASSERT_EQ(v.size(), 10);
+    ASSERT_EQ(v[7][0], 7);
+    ASSERT_EQ(v[7][2], 21);
+    ASSERT_EQ(v[9][1], 18);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "dummy_task.h"
+#include "myplan/search/external_breadth_first_search.h"
+#include "myplan/search/record_file.h"
+
+TEST(RecordFile, WriteAndRead) {
+    std::string path =
+        (std::filesystem::temp_directory_path() / "myplan-test-records.bin")
+            .string();
+    for (bool direct_io : {false, true}) {
+        // records of 3 words straddle the block boundaries
+        const size_t n = 100000;
+        {
+            RecordWriter writer(path, 3 * sizeof(uint64_t), direct_io);
+            for (uint64_t i = 0; i < n; i++) {
+                uint64_t record[3] = {i, i * 2, ~i};
+                writer.write(record);
+            }
+            writer.close();
+            ASSERT_EQ(writer.size(), n);
+            ASSERT_EQ(writer.io_bytes(), n * 3 * sizeof(uint64_t));
+        }
+        RecordReader reader(path, 3 * sizeof(uint64_t), direct_io);
+        uint64_t i = 0;
+        for (; !reader.done(); reader.next(), i++) {
+            const uint64_t* record = (const uint64_t*)reader.current();
+            ASSERT_EQ(record[0], i);
+            ASSERT_EQ(record[1], i * 2);
+            ASSERT_EQ(record[2], ~i);
+        }
+        ASSERT_EQ(i, n);
+        ASSERT_EQ(reader.io_bytes(), n * 3 * sizeof(uint64_t));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(external_breadth_first, SearchWithSmallBuffer) {
+    // a buffer of two states forces many runs per layer
+    ExternalSearchConfig config;
+    config.memory_bytes = 2 * sizeof(uint64_t);
+    for (bool direct_io : {false, true}) {
+        config.direct_io = direct_io;
+        DummyTask task = get_search_space_at_goal();
+        ASSERT_EQ(external_breadth_first_search(task, config).size(), 0);
+        DummyTask task2 = get_search_no_solution();
+        ASSERT_EQ(external_breadth_first_search(task2, config).size(), 0);
+        DummyTask task3 = get_simple_search_space();
+        ASSERT_EQ(external_breadth_first_search(task3, config).size(), 3);
+        DummyTask task4 = get_simple_search_space2();
+        std::vector<int> expected = {0, 0, 0, 0};
+        ASSERT_EQ(external_breadth_first_search(task4, config), expected);
+    }
+}
+
+TEST(external_breadth_first, SearchAgainstRecentLayers) {
+    ExternalSearchConfig config;
+    for (int duplicate_layers : {1, 2}) {
+        config.duplicate_layers = duplicate_layers;
+        DummyTask task = get_simple_search_space();
+        ASSERT_EQ(external_breadth_first_search(task, config).size(), 3);
+        DummyTask task2 = get_simple_search_space2();
+        std::vector<int> expected = {0, 0, 0, 0};
+        ASSERT_EQ(external_breadth_first_search(task2, config), expected);
+    }
+}
+
+TEST(external_breadth_first, RemovesItsFiles) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "myplan-test-layers";
+    std::filesystem::create_directories(directory);
+    ExternalSearchConfig config;
+    config.directory = directory.string();
+    DummyTask task = get_simple_search_space();
+    ASSERT_EQ(external_breadth_first_search(task, config).size(), 3);
+    ASSERT_TRUE(std::filesystem::is_empty(directory));
+    std::filesystem::remove(directory);
+}
@@ -525,3 +525,45 @@ TEST(grounding, Operators) {
     }
 }
 
+
+TEST(grounding, DenseIds) {
+    Parser parser = Parser("");
+    std::string dom =
+        "(define (domain dense) (:requirements :typing) (:predicates (at ?x "
+        "- object) (visited ?x - object) (at-home)) (:action move "
+        ":parameters (?from ?to - object) :precondition (at ?from) :effect "
+        "(and (at ?to) (visited ?to) (not (at ?from)))) (:action leave "
+        ":parameters (?x - object) :precondition (at ?x) :effect (and "
+        "(at-home) (not (at ?x)))))";
+    std::string prob =
+        "(define (problem dense-1) (:domain dense) (:objects a b c - object) "
+        "(:init (at a)) (:goal (and (visited c) (at-home))))";
+    Problem problem = parse_problem(parser, dom, prob);
+    Task task = ground(problem);
+
+    int num_facts = task.reverse_encoding_map.size();
+    ASSERT_EQ(num_facts, (int)task.facts.size());
+    ASSERT_EQ(task.num_facts, num_facts);
+    for (int f = 0; f < num_facts; f++) {
+        ASSERT_EQ(task.facts.count(f), 1);
+        ASSERT_EQ(task.encoding_map[task.reverse_encoding_map[f]], f);
+    }
+    // atoms of the same predicate are adjacent
+    std::vector<std::string> predicates;
+    for (const std::string& fact : task.reverse_encoding_map) {
+        std::string predicate = _get_predicate_name(fact);
+        if (predicates.empty() || predicates.back() != predicate) {
+            ASSERT_EQ(std::count(predicates.begin(), predicates.end(),
+                                 predicate),
+                      0);
+            predicates.push_back(predicate);
+        }
+    }
+    ASSERT_EQ(predicates.size(), 3);
+
+    ASSERT_EQ(task.action_id2name.size(), task.operators.size());
+    for (int op = 0; op < (int)task.operators.size(); op++) {
+        ASSERT_EQ(task.operators[op].name, op);
+        ASSERT_EQ(task.operator_table.index(op), op);
+    }
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dummy_task.h"
+#include "myplan/search/hda_star.h"
+
+namespace {
+
+struct ZeroHeuristic : Heuristic {
+    float calculate_h(int, SearchSpace&) { return 0; }
+};
+
+struct DistanceHeuristic : Heuristic {
+    // an admissible estimate of the distance to "target" in the dummy tasks
+    int target;
+    DistanceHeuristic(int target) : target(target) {}
+    float calculate_h(int this_id, SearchSpace& space) {
+        for (int s : space.state(this_id)) {
+            return std::floor((float)std::abs(target - s) / 2);
+        }
+        return 0;
+    }
+};
+
+}  // namespace
+
+TEST(hda_star, FindsOptimalPlans) {
+    for (int num_threads : {1, 2, 4}) {
+        for (std::string open_list : {"auto", "heap"}) {
+            HeuristicFactory zero = []() {
+                return std::make_unique<ZeroHeuristic>();
+            };
+            DummyTask task = get_simple_search_space();
+            ASSERT_EQ(hda_star(task, zero, num_threads, open_list).size(), 3);
+            DummyTask task2 = get_simple_search_space2();
+            ASSERT_EQ(hda_star(task2, zero, num_threads, open_list).size(),
+                      4);
+            HeuristicFactory distance = []() {
+                return std::make_unique<DistanceHeuristic>(1);
+            };
+            ASSERT_EQ(
+                hda_star(task2, distance, num_threads, open_list).size(), 4);
+        }
+    }
+}
+
+TEST(hda_star, GoalAndNoSolution) {
+    HeuristicFactory zero = []() { return std::make_unique<ZeroHeuristic>(); };
+    for (int num_threads : {1, 3}) {
+        DummyTask task = get_search_space_at_goal();
+        ASSERT_EQ(hda_star(task, zero, num_threads).size(), 0);
+        DummyTask task2 = get_search_no_solution();
+        HDAStar search(task2, zero, num_threads);
+        ASSERT_EQ(search.search().size(), 0);
+        // every state from 0 to 10 is expanded
+        ASSERT_GE(search.statistics.expanded, 11);
+    }
+}
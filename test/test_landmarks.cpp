@@ -101,24 +101,42 @@ TEST(LandmarkHeuristic, Heuristics) {
     Task task4("task4", s_abc, s_a, s_cb, ops4);
 
     LandmarkHeuristic heuristic1(task1);
-    vector<SearchNode> nodes1 = {make_root_node(task1.initial_state)};
+    SearchSpace space1(task1.initial_state.num_words());
+    space1.add_node(make_root_node(
+        space1
+            .registry
+            .insert(task1.initial_state,
+                    task1.get_hash(task1.initial_state))
+            .first));
     flat_hash_set<int> expected_landmark1 = {1, 2};
     flat_hash_map<int, float> expected_lmc1 = {{1, 1}, {2, 1}};
     ASSERT_EQ(get_landmarks(task1), expected_landmark1);
     ASSERT_EQ(compute_landmark_costs(task1, expected_landmark1), expected_lmc1);
-    ASSERT_EQ(heuristic1.calculate_h(0, nodes1), 2);
+    ASSERT_EQ(heuristic1.calculate_h(0, space1), 2);
 
     LandmarkHeuristic heuristic2(task2);
-    vector<SearchNode> nodes2 = {make_root_node(task2.initial_state)};
+    SearchSpace space2(task2.initial_state.num_words());
+    space2.add_node(make_root_node(
+        space2
+            .registry
+            .insert(task2.initial_state,
+                    task2.get_hash(task2.initial_state))
+            .first));
     ASSERT_EQ(get_landmarks(task2), expected_landmark1);
     ASSERT_EQ(compute_landmark_costs(task2, expected_landmark1), expected_lmc1);
-    ASSERT_EQ(heuristic2.calculate_h(0, nodes2), 1);
+    ASSERT_EQ(heuristic2.calculate_h(0, space2), 1);
 
     LandmarkHeuristic heuristic4(task4);
-    vector<SearchNode> nodes4 = {make_root_node(task4.initial_state)};
+    SearchSpace space4(task4.initial_state.num_words());
+    space4.add_node(make_root_node(
+        space4
+            .registry
+            .insert(task4.initial_state,
+                    task4.get_hash(task4.initial_state))
+            .first));
     flat_hash_set<int> expected_landmark4 = {1, 2};
     flat_hash_map<int, float> expected_lmc4 = {{1, 0.5}, {2, 0.5}};
     ASSERT_EQ(get_landmarks(task4), expected_landmark4);
     ASSERT_EQ(compute_landmark_costs(task4, expected_landmark4), expected_lmc4);
-    ASSERT_EQ(heuristic4.calculate_h(0, nodes4), 1);
+    ASSERT_EQ(heuristic4.calculate_h(0, space4), 1);
 }
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "myplan/search/mpsc_queue.h"
+
+struct Item {
+    int producer;
+    int value;
+    std::atomic<Item*> next{nullptr};
+};
+
+TEST(MPSCQueue, SingleThreadFIFO) {
+    MPSCQueue<Item> queue;
+    ASSERT_EQ(queue.pop(), nullptr);
+    std::vector<Item> items(3);
+    for (int i = 0; i < 3; i++) {
+        items[i].value = i;
+        queue.push(&items[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        Item* item = queue.pop();
+        ASSERT_NE(item, nullptr);
+        ASSERT_EQ(item->value, i);
+    }
+    ASSERT_EQ(queue.pop(), nullptr);
+    queue.push(&items[1]);
+    ASSERT_EQ(queue.pop(), &items[1]);
+}
+
+TEST(MPSCQueue, ManyProducers) {
+    const int num_producers = 4;
+    const int num_items = 10000;
+    MPSCQueue<Item> queue;
+    std::vector<std::vector<Item>> items(num_producers);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; p++) {
+        items[p] = std::vector<Item>(num_items);
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < num_items; i++) {
+                items[p][i].producer = p;
+                items[p][i].value = i;
+                queue.push(&items[p][i]);
+            }
+        });
+    }
+    // the items of every producer arrive in order
+    std::vector<int> next_value(num_producers, 0);
+    int received = 0;
+    while (received < num_producers * num_items) {
+        Item* item = queue.pop();
+        if (item == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item->value, next_value[item->producer]);
+        next_value[item->producer]++;
+        received++;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    ASSERT_EQ(queue.pop(), nullptr);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/search/open_list.h"
+
+template <typename OpenList>
+std::vector<int> pop_all(OpenList& open) {
+    std::vector<int> nodes;
+    while (!open.empty()) {
+        nodes.push_back(open.pop());
+    }
+    return nodes;
+}
+
+TEST(OpenList, HeapOrdersByKeyAndTie) {
+    HeapOpenList open;
+    open.push(3, 1, 0);
+    open.push(2.5, 2, 1);
+    open.push(2.5, 0.5, 2);
+    open.push(4, 0, 3);
+    ASSERT_EQ(open.size(), 4);
+    std::vector<int> expected = {2, 1, 0, 3};
+    ASSERT_EQ(pop_all(open), expected);
+}
+
+TEST(OpenList, BucketOrdersByKeyAndTie) {
+    BucketOpenList open;
+    open.push(3, 1, 0);
+    open.push(2, 2, 1);
+    open.push(2, 0, 2);
+    open.push(5, 0, 3);
+    open.push(2, 0, 4);
+    ASSERT_EQ(open.size(), 5);
+    ASSERT_EQ(open.pop(), 4);
+    ASSERT_EQ(open.pop(), 2);
+    // a smaller key pushed after popping
+    open.push(1, 7, 5);
+    std::vector<int> expected = {5, 1, 0, 3};
+    ASSERT_EQ(pop_all(open), expected);
+    open.push(0, 0, 6);
+    ASSERT_EQ(open.pop(), 6);
+}
+
+TEST(OpenList, RadixHeapOrdersMonotoneKeys) {
+    RadixHeapOpenList open;
+    open.push(3, 1, 0);
+    open.push(2, 2, 1);
+    open.push(2, 0, 2);
+    open.push(70000, 0, 3);
+    ASSERT_EQ(open.pop(), 2);
+    open.push(2, 1, 4);
+    open.push(3, 0, 5);
+    std::vector<int> expected = {4, 1, 5, 0, 3};
+    ASSERT_EQ(pop_all(open), expected);
+}
+
+TEST(OpenList, RadixHeapNonMonotonePush) {
+    RadixHeapOpenList open;
+    open.push(2, 5, 0);
+    open.push(4, 0, 1);
+    ASSERT_EQ(open.pop(), 0);
+    // a smaller tie with the last popped key is raised to the last popped
+    // pair: it still comes before larger keys
+    open.push(2, 1, 2);
+    open.push(3, 0, 3);
+    std::vector<int> expected = {2, 3, 1};
+    ASSERT_EQ(pop_all(open), expected);
+    // a smaller key would be popped out of order
+    EXPECT_DEBUG_DEATH(open.push(1, 0, 4), "non-monotone");
+}
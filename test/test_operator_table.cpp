@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/operator_table.h"
+#include "myplan/task.h"
+
+TEST(OperatorTable, CompressedRows) {
+    OperatorTable table;
+    ASSERT_EQ(table.size(), 0);
+    ASSERT_EQ(table.add_operator(7, {3, 1, 3}, {2}, {}), 0);
+    ASSERT_EQ(table.add_operator(8, {}, {4, 65}, {1}, 3), 1);
+    ASSERT_EQ(table.size(), 2);
+
+    std::vector<int> pre0(table.pre(0).begin(), table.pre(0).end());
+    std::vector<int> expected_pre0 = {1, 3};
+    ASSERT_EQ(pre0, expected_pre0);
+    ASSERT_TRUE(table.pre(1).empty());
+    ASSERT_EQ(table.add(1).size(), 2);
+    ASSERT_EQ(table.add(1)[1], 65);
+    ASSERT_EQ(table.del(1)[0], 1);
+    ASSERT_EQ(table.name(1), 8);
+    ASSERT_EQ(table.index(8), 1);
+    ASSERT_EQ(table.index(3), -1);
+    ASSERT_EQ(table.cost(0), 1);
+    ASSERT_EQ(table.cost(1), 3);
+    ASSERT_EQ(table.effect_masks(1).size(), 2);
+
+    State s = {1, 3};
+    ASSERT_TRUE(table.applicable(0, s));
+    ASSERT_TRUE(table.applicable(1, s));
+    s.erase(3);
+    ASSERT_FALSE(table.applicable(0, s));
+}
+
+TEST(OperatorTable, TaskReadsFromTable) {
+    std::vector<int> v1 = {1};
+    std::vector<int> v2 = {2};
+    std::vector<int> v3 = {};
+    EncodedOperator op1(4, v1, v2, v3);
+    EncodedOperator op2(5, v2, v3, v1);
+    flat_hash_set<int> facts = {1, 2};
+    State init = {1};
+    flat_hash_set<int> goals = {2};
+    Task task("task", facts, init, goals, {op1, op2});
+    ASSERT_EQ(task.operator_table.size(), 2);
+    ASSERT_EQ(task.operator_table.name(1), 5);
+    ASSERT_EQ(task.operator_table.del(1)[0], 1);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "myplan/heuristic/relaxation.h"
+#include "myplan/task.h"
+
+// 0 -a-> 1 -b-> 2 (goal) and 0 -c-> 3
+Task get_chain_task() {
+    std::vector<int> none = {};
+    std::vector<int> f0 = {0}, f1 = {1}, f2 = {2}, f3 = {3};
+    EncodedOperator a(10, f0, f1, none);
+    EncodedOperator b(11, f1, f2, none);
+    EncodedOperator c(12, f0, f3, none);
+    flat_hash_set<int> facts = {0, 1, 2, 3};
+    return Task("chain", facts, State({0}), State({2}), {a, b, c});
+}
+
+TEST(RelaxationHeuristic, HelpfulActions) {
+    Task task = get_chain_task();
+    hAddHeuristic heuristic(task);
+    SearchSpace space(task.initial_state.num_words());
+    StateID id =
+        space.registry
+            .insert(task.initial_state, task.get_hash(task.initial_state))
+            .first;
+    space.add_node(make_root_node(id));
+    ASSERT_EQ(heuristic.calculate_h(0, space), 2);
+    std::vector<int> preferred;
+    heuristic.get_preferred_operators(0, space, preferred);
+    std::vector<int> expected = {10};
+    ASSERT_EQ(preferred, expected);
+    std::vector<int> relaxed_plan = heuristic.relaxed_plan;
+    std::sort(relaxed_plan.begin(), relaxed_plan.end());
+    std::vector<int> expected_plan = {0, 1};
+    ASSERT_EQ(relaxed_plan, expected_plan);
+}
+
+TEST(RelaxationHeuristic, FFCountsSharedOperatorsOnce) {
+    // both goals 2 and 4 need the operator "a" that adds 1
+    std::vector<int> none = {};
+    std::vector<int> f0 = {0}, f1 = {1}, f2 = {2}, f4 = {4};
+    EncodedOperator a(10, f0, f1, none);
+    EncodedOperator b(11, f1, f2, none);
+    EncodedOperator d(13, f1, f4, none);
+    flat_hash_set<int> facts = {0, 1, 2, 4};
+    Task task("fork", facts, State({0}), State({2, 4}), {a, b, d});
+    SearchSpace space(task.initial_state.num_words());
+    StateID id =
+        space.registry
+            .insert(task.initial_state, task.get_hash(task.initial_state))
+            .first;
+    space.add_node(make_root_node(id));
+
+    hAddHeuristic h_add(task);
+    ASSERT_EQ(h_add.calculate_h(0, space), 4);
+    hFFHeuristic h_ff(task);
+    ASSERT_EQ(h_ff.calculate_h(0, space), 3);
+    std::vector<int> preferred;
+    h_ff.get_preferred_operators(0, space, preferred);
+    std::vector<int> expected = {10};
+    ASSERT_EQ(preferred, expected);
+}
+
+TEST(RelaxationHeuristic, RepeatedEvaluations) {
+    std::vector<int> none = {};
+    std::vector<int> f0 = {0}, f1 = {1}, f2 = {2}, f4 = {4};
+    EncodedOperator a(10, f0, f1, none);
+    EncodedOperator b(11, f1, f2, none);
+    EncodedOperator d(13, f1, f4, none);
+    flat_hash_set<int> facts = {0, 1, 2, 4, 5};
+    Task task("fork", facts, State({0}), State({2, 4}), {a, b, d});
+    SearchSpace space(task.initial_state.num_words());
+    for (State state : {State({0}), State({1}), State({5}), State({0})}) {
+        StateID id = space.registry.insert(state, task.get_hash(state)).first;
+        space.add_node(make_root_node(id));
+    }
+
+    hAddHeuristic h_add(task);
+    hMaxHeuristic h_max(task);
+    std::vector<float> expected_add = {4, 2, FLOAT_INF, 4};
+    std::vector<float> expected_max = {2, 1, FLOAT_INF, 2};
+    for (int i = 0; i < space.size(); i++) {
+        ASSERT_EQ(h_add.calculate_h(i, space), expected_add[i]);
+        ASSERT_EQ(h_max.calculate_h(i, space), expected_max[i]);
+    }
+}
+
+// a robot moves along the cells 0-3 (facts 0-3), fetches the key (fact 4)
+// at cell 3 and opens the door (fact 5) at cell 0 with it
+Task get_door_task() {
+    std::vector<int> none = {};
+    std::vector<EncodedOperator> operators;
+    for (int i = 0; i < 3; i++) {
+        std::vector<int> from = {i}, to = {i + 1};
+        operators.emplace_back(2 * i, from, to, from);
+        operators.emplace_back(2 * i + 1, to, from, to);
+    }
+    std::vector<int> at3 = {3}, key = {4}, at0_key = {0, 4}, door = {5};
+    operators.emplace_back(6, at3, key, none);
+    operators.emplace_back(7, at0_key, door, key);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4, 5};
+    return Task("door", facts, State({0}), State({5}), operators);
+}
+
+// Add the successors of the nodes of "space" in breadth-first order until
+// "max_nodes" nodes are expanded, calling "visit" before each expansion
+template <class Visit>
+int expand_breadth_first(Task& task, SearchSpace& space, int max_nodes,
+                         Visit visit) {
+    StateID root_state_id =
+        space.registry
+            .insert(task.initial_state, task.get_hash(task.initial_state))
+            .first;
+    space.add_node(make_root_node(root_state_id));
+    int expanded = 0;
+    for (int node_idx = 0; node_idx < space.size() && node_idx < max_nodes;
+         node_idx++) {
+        expanded++;
+        visit(node_idx);
+        task.for_each_successor(
+            space.state(node_idx), space.hash(node_idx),
+            [&](const Successor& succ) {
+                space.add_node(make_child_node(node_idx, space[node_idx].g,
+                                               succ.action,
+                                               space.registry.insert(succ)
+                                                   .first));
+            });
+    }
+    return expanded;
+}
+
+TEST(RelaxationHeuristic, IncrementalEvaluations) {
+    Task task = get_door_task();
+
+    hAddHeuristic h_add(task);
+    hMaxHeuristic h_max(task);
+    hFFHeuristic h_ff(task);
+    // repairs allowed up to all facts
+    hAddHeuristic cached_add(task, 64);
+    cached_add.max_affected_fraction = 1;
+    hMaxHeuristic cached_max(task, 1);
+    cached_max.max_affected_fraction = 1;
+    hFFHeuristic cached_ff(task, 1);
+    cached_ff.max_affected_fraction = 1;
+    // repairs only if no fact is deleted
+    hAddHeuristic full_add(task, 4);
+    full_add.max_affected_fraction = 0;
+
+    // breadth-first search evaluating every node right after its parent
+    SearchSpace space(task.initial_state.num_words());
+    std::vector<_RelaxationHeuristic*> heuristics = {
+        &h_add,      &h_max,     &h_ff,     &cached_add,
+        &cached_max, &cached_ff, &full_add};
+    int evaluated = expand_breadth_first(task, space, 30, [&](int node_idx) {
+        std::vector<float> h;
+        std::vector<std::vector<int>> preferred(heuristics.size());
+        for (size_t i = 0; i < heuristics.size(); i++) {
+            h.push_back(heuristics[i]->calculate_h(node_idx, space));
+            heuristics[i]->get_preferred_operators(node_idx, space,
+                                                   preferred[i]);
+        }
+        ASSERT_EQ(h[3], h[0]);
+        ASSERT_EQ(h[6], h[0]);
+        ASSERT_EQ(h[4], h[1]);
+        ASSERT_EQ(h[5], h[2]);
+        ASSERT_EQ(preferred[5], preferred[2]);
+    });
+    ASSERT_EQ(evaluated, 30);
+    // every parent is kept
+    ASSERT_EQ(cached_add.incremental_evaluations, evaluated - 1);
+    ASSERT_GT(cached_ff.incremental_evaluations, 0);
+    ASSERT_GT(full_add.full_evaluations, 1);
+    ASSERT_EQ(full_add.incremental_evaluations + full_add.full_evaluations,
+              evaluated);
+}
+
+TEST(RelaxationHeuristic, IncrementalEvaluationsSurviveHashCollisions) {
+    // every state hashes to the same value, so the cache keeps only the
+    // last evaluated state and must not repair from it for other parents
+    Task task = get_door_task();
+    task.zobrist.keys.assign(task.zobrist.size(), state_hash_t());
+    hAddHeuristic h_add(task);
+    hMaxHeuristic h_max(task);
+    hAddHeuristic cached_add(task, 64);
+    cached_add.max_affected_fraction = 1;
+    hMaxHeuristic cached_max(task, 64);
+    cached_max.max_affected_fraction = 1;
+
+    SearchSpace space(task.initial_state.num_words());
+    int evaluated = expand_breadth_first(task, space, 30, [&](int node_idx) {
+        ASSERT_EQ(cached_add.calculate_h(node_idx, space),
+                  h_add.calculate_h(node_idx, space));
+        ASSERT_EQ(cached_max.calculate_h(node_idx, space),
+                  h_max.calculate_h(node_idx, space));
+    });
+    ASSERT_EQ(evaluated, 30);
+    ASSERT_GT(cached_add.full_evaluations, 1);
+}
@@ -1,11 +1,23 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "dummy_task.h"
+#include "myplan/grounding.h"
+#include "myplan/heuristic/relaxation.h"
+#include "myplan/pddl/parser.h"
+#include "myplan/search/anytime_search.h"
+#include "myplan/search/astar.h"
 #include "myplan/search/breadth_first_search.h"
+#include "myplan/search/enforced_hill_climbing.h"
+#include "myplan/search/frontier_search.h"
+#include "myplan/search/ida_star.h"
+#include "myplan/search/parallel_breadth_first_search.h"
+#include "myplan/search/portfolio.h"
+#include "myplan/search/sma_star.h"
 
 TEST(breadth_first, SearchAtGoal) {
     DummyTask task = get_search_space_at_goal();
@@ -30,3 +42,371 @@ TEST(breadth_first, SearchFourStep) {
     std::vector<int> solution = breadth_first_search(task);
     ASSERT_EQ(solution.size(), 4);
 }
+
+struct ZeroHeuristic : Heuristic {
+    float calculate_h(int, SearchSpace&) { return 0; }
+    bool consistent() { return true; }
+};
+
+TEST(astar, SearchWithEveryOpenList) {
+    for (std::string open_list : {"auto", "bucket", "radix", "heap"}) {
+        DummyTask task = get_simple_search_space();
+        ZeroHeuristic heuristic;
+        ASSERT_EQ(astar(task, heuristic, open_list).size(), 3);
+        DummyTask task2 = get_simple_search_space2();
+        ASSERT_EQ(astar(task2, heuristic, open_list).size(), 4);
+        DummyTask task3 = get_search_no_solution();
+        ASSERT_EQ(astar(task3, heuristic, open_list).size(), 0);
+    }
+}
+
+struct DistanceHeuristic : Heuristic {
+    // the distance to the goal "target" in the dummy tasks
+    int target;
+    DistanceHeuristic(int target) : target(target) {}
+    float calculate_h(int this_id, SearchSpace& space) {
+        for (int s : space.state(this_id)) {
+            return (float)std::abs(target - s) / 2;
+        }
+        return 0;
+    }
+    bool integer_valued() { return false; }
+};
+
+TEST(best_first, GreedyAndWeighted) {
+    for (bool reopen : {true, false}) {
+        for (std::string tie : {"auto", "h", "g", "lifo"}) {
+            BestFirstConfig config;
+            config.reopen_closed = reopen;
+            config.tie_breaking = tie;
+            DummyTask task = get_simple_search_space();
+            DistanceHeuristic heuristic(10);
+            ASSERT_EQ(gbfs(task, heuristic, config).size(), 3);
+            ASSERT_EQ(wastar(task, heuristic, 1.5, config).size(), 3);
+            DummyTask task2 = get_simple_search_space2();
+            DistanceHeuristic heuristic2(1);
+            ASSERT_EQ(gbfs(task2, heuristic2, config).size(), 4);
+            ASSERT_EQ(wastar(task2, heuristic2, 3, config, "heap").size(),
+                      4);
+        }
+    }
+    DummyTask task = get_search_no_solution();
+    ZeroHeuristic heuristic;
+    ASSERT_EQ(gbfs(task, heuristic).size(), 0);
+}
+
+struct CountingHeuristic : DistanceHeuristic {
+    // prefers the operator "preferred_action" and counts evaluations
+    int preferred_action;
+    int evaluations = 0;
+    CountingHeuristic(int target, int preferred_action)
+        : DistanceHeuristic(target), preferred_action(preferred_action) {}
+    float calculate_h(int this_id, SearchSpace& space) {
+        evaluations++;
+        return DistanceHeuristic::calculate_h(this_id, space);
+    }
+    bool provides_preferred_operators() { return true; }
+    void get_preferred_operators(int, SearchSpace&,
+                                 std::vector<int>& preferred) {
+        preferred.push_back(preferred_action);
+    }
+};
+
+struct PreferringZeroHeuristic : ZeroHeuristic {
+    bool provides_preferred_operators() { return true; }
+};
+
+TEST(best_first, LazyEvaluation) {
+    for (bool preferred : {false, true}) {
+        for (std::string open_list : {"auto", "heap"}) {
+            BestFirstConfig config;
+            DummyTask task = get_simple_search_space();
+            CountingHeuristic eager_heuristic(10, 2);
+            ASSERT_EQ(gbfs(task, eager_heuristic, config, open_list).size(),
+                      3);
+
+            config.lazy = true;
+            config.preferred_operators = preferred;
+            CountingHeuristic heuristic(10, 2);
+            ASSERT_EQ(gbfs(task, heuristic, config, open_list).size(), 3);
+            ASSERT_LT(heuristic.evaluations, eager_heuristic.evaluations);
+            DummyTask task2 = get_simple_search_space2();
+            CountingHeuristic heuristic2(1, 0);
+            ASSERT_EQ(wastar(task2, heuristic2, 2, config, open_list).size(),
+                      4);
+        }
+    }
+    BestFirstConfig config;
+    config.lazy = true;
+    config.preferred_operators = true;
+    // the keys of lazy and greedy searches are not monotone
+    DummyTask radix_task = get_simple_search_space();
+    ZeroHeuristic zero;
+    ASSERT_THROW(best_first_search(radix_task, zero, config, "radix"),
+                 std::invalid_argument);
+    CountingHeuristic radix_heuristic(10, 2);
+    ASSERT_THROW(gbfs(radix_task, radix_heuristic, BestFirstConfig(), "radix"),
+                 std::invalid_argument);
+    // nor are those of the preferred queue, which also receives successors
+    // of nodes popped from the main queue
+    BestFirstConfig preferred_config;
+    preferred_config.preferred_operators = true;
+    PreferringZeroHeuristic preferring_zero;
+    ASSERT_THROW(best_first_search(radix_task, preferring_zero,
+                                   preferred_config, "radix"),
+                 std::invalid_argument);
+    // the bucket queue would round fractional keys
+    ASSERT_THROW(gbfs(radix_task, radix_heuristic, BestFirstConfig(), "bucket"),
+                 std::invalid_argument);
+    DummyTask task = get_search_no_solution();
+    CountingHeuristic heuristic(20, 2);
+    ASSERT_EQ(gbfs(task, heuristic, config).size(), 0);
+}
+
+TEST(best_first, EagerPreferredOperators) {
+    BestFirstConfig config;
+    config.preferred_operators = true;
+    DummyTask task = get_simple_search_space();
+    CountingHeuristic heuristic(10, 2);
+    ASSERT_EQ(gbfs(task, heuristic, config).size(), 3);
+    DummyTask task2 = get_simple_search_space2();
+    CountingHeuristic heuristic2(1, 0);
+    ASSERT_EQ(wastar(task2, heuristic2, 2, config).size(), 4);
+    // preferred operators cost no heuristic evaluations of their own
+    DummyTask plain_task = get_simple_search_space();
+    CountingHeuristic plain_heuristic(10, 2);
+    gbfs(plain_task, plain_heuristic);
+    ASSERT_EQ(heuristic.evaluations, plain_heuristic.evaluations);
+    DummyTask plain_task2 = get_simple_search_space2();
+    CountingHeuristic plain_heuristic2(1, 0);
+    wastar(plain_task2, plain_heuristic2, 2);
+    ASSERT_EQ(heuristic2.evaluations, plain_heuristic2.evaluations);
+}
+
+TEST(parallel_breadth_first, SearchWithThreads) {
+    for (int num_threads : {1, 2, 4}) {
+        DummyTask task = get_search_space_at_goal();
+        ASSERT_EQ(parallel_breadth_first_search(task, num_threads).size(), 0);
+        DummyTask task2 = get_search_no_solution();
+        ASSERT_EQ(parallel_breadth_first_search(task2, num_threads).size(),
+                  0);
+        DummyTask task3 = get_simple_search_space();
+        ASSERT_EQ(parallel_breadth_first_search(task3, num_threads).size(),
+                  3);
+        DummyTask task4 = get_simple_search_space2();
+        ASSERT_EQ(parallel_breadth_first_search(task4, num_threads).size(),
+                  4);
+        // one node per chunk to expand even small layers on all threads
+        ASSERT_EQ(parallel_breadth_first_search(task3, num_threads, 1).size(),
+                  3);
+        ASSERT_EQ(parallel_breadth_first_search(task4, num_threads, 1).size(),
+                  4);
+    }
+}
+
+TEST(parallel_breadth_first, ShardedRegistry) {
+    ShardedStateRegistry registry(1);
+    ZobristTable zobrist(64);
+    for (int i = 0; i < 64; i++) {
+        State s = {i};
+        ASSERT_TRUE(registry.insert(HashedState{s, zobrist.hash(s)}));
+        ASSERT_FALSE(registry.insert(HashedState{s, zobrist.hash(s)}));
+    }
+    ASSERT_EQ(registry.size(), 64);
+}
+
+TEST(frontier_breadth_first, SearchWithLayers) {
+    DummyTask task = get_search_space_at_goal();
+    ASSERT_EQ(frontier_breadth_first_search(task).size(), 0);
+    DummyTask task2 = get_search_no_solution();
+    ASSERT_EQ(frontier_breadth_first_search(task2, 50).size(), 0);
+    DummyTask task3 = get_simple_search_space();
+    std::vector<int> solution = frontier_breadth_first_search(task3);
+    std::vector<int> expected = {2, 2, 1};
+    std::sort(solution.begin(), solution.end());
+    std::reverse(solution.begin(), solution.end());
+    ASSERT_EQ(solution, expected);
+    DummyTask task4 = get_simple_search_space2();
+    solution = frontier_breadth_first_search(task4);
+    expected = {0, 0, 0, 0};
+    ASSERT_EQ(solution, expected);
+    ASSERT_EQ(frontier_breadth_first_search(task4, 3).size(), 0);
+}
+
+TEST(ida_star, SearchWithAndWithoutTable) {
+    for (int table_bits : {0, 4, 16}) {
+        DummyTask task = get_search_space_at_goal();
+        ZeroHeuristic zero;
+        ASSERT_EQ(ida_star(task, zero, table_bits).size(), 0);
+        DummyTask task2 = get_simple_search_space();
+        ASSERT_EQ(ida_star(task2, zero, table_bits).size(), 3);
+        DummyTask task3 = get_simple_search_space2();
+        std::vector<int> expected = {0, 0, 0, 0};
+        ASSERT_EQ(ida_star(task3, zero, table_bits), expected);
+        // the bound grows until no node is cut off
+        DummyTask task4 = get_search_no_solution();
+        ASSERT_EQ(ida_star(task4, zero, table_bits).size(), 0);
+    }
+}
+
+TEST(ida_star, TranspositionTablePrunes) {
+    DummyTask task = get_simple_search_space2();
+    ZeroHeuristic zero;
+    IDAStar without_table(task, zero, 0);
+    ASSERT_EQ(without_table.search().size(), 4);
+    IDAStar with_table(task, zero, 16);
+    ASSERT_EQ(with_table.search().size(), 4);
+    ASSERT_LT(with_table.statistics.expanded,
+              without_table.statistics.expanded);
+}
+
+TEST(ida_star, TranspositionTableSurvivesHashCollisions) {
+    // every state hashes to the same value
+    DummyTask task = get_simple_search_space2();
+    task.zobrist.keys.assign(task.zobrist.size(), state_hash_t());
+    ZeroHeuristic zero;
+    std::vector<int> expected = {0, 0, 0, 0};
+    ASSERT_EQ(ida_star(task, zero, 16), expected);
+}
+
+TEST(sma_star, SearchWithLargeBudget) {
+    size_t budget = size_t(64) << 20;
+    DummyTask task = get_search_space_at_goal();
+    ZeroHeuristic zero;
+    ASSERT_EQ(sma_star(task, zero, budget).size(), 0);
+    DummyTask task2 = get_simple_search_space();
+    ASSERT_EQ(sma_star(task2, zero, budget).size(), 3);
+    DummyTask task3 = get_simple_search_space2();
+    std::vector<int> expected = {0, 0, 0, 0};
+    ASSERT_EQ(sma_star(task3, zero, budget), expected);
+    DummyTask task4 = get_search_no_solution();
+    SMAStar search(task4, zero, budget);
+    ASSERT_EQ(search.search().size(), 0);
+    ASSERT_FALSE(search.out_of_memory);
+}
+
+TEST(sma_star, SearchWithSmallBudget) {
+    DummyTask task = get_simple_search_space2();
+    ZeroHeuristic zero;
+    SMAStar tiny(task, zero, 0);
+    ASSERT_EQ(tiny.search().size(), 0);
+    ASSERT_TRUE(tiny.out_of_memory);
+
+    // the smallest budget that finds a plan has to forget nodes
+    size_t budget = tiny.fixed_bytes;
+    while (true) {
+        SMAStar search(task, zero, budget);
+        std::vector<int> solution = search.search();
+        if (!solution.empty()) {
+            std::vector<int> expected = {0, 0, 0, 0};
+            ASSERT_EQ(solution, expected);
+            ASSERT_GT(search.forgotten, 0);
+            break;
+        }
+        budget += search.node_bytes();
+    }
+}
+
+TEST(sma_star, SmallBudgetOnGripper) {
+    std::string directory = std::string(MYPLAN_BENCHMARK_DIR) + "/gripper/";
+    Parser parser(directory + "domain.pddl", directory + "task01.pddl");
+    Domain* domain = parser.parse_domain(true);
+    Problem problem = *parser.parse_problem(domain, true);
+    Task task = ground(problem);
+    hMaxHeuristic heuristic(task);
+
+    SMAStar unbounded(task, heuristic, size_t(64) << 20);
+    size_t optimal_length = unbounded.search().size();
+    ASSERT_EQ(optimal_length, 11);
+    // room for about a third of the nodes of the unbounded search
+    SMAStar search(task, heuristic,
+                   unbounded.fixed_bytes + 150 * unbounded.node_bytes());
+    ASSERT_EQ(search.search().size(), optimal_length);
+    ASSERT_GT(search.forgotten, 0);
+    ASSERT_FALSE(search.out_of_memory);
+}
+
+struct ParityHeuristic : Heuristic {
+    // admissible in "0to10", but misleads weighted A* along odd states
+    int evaluations = 0;
+    float calculate_h(int this_id, SearchSpace& space) {
+        evaluations++;
+        for (int s : space.state(this_id)) {
+            return s % 2 == 1 ? 0 : (float)(10 - s) / 2;
+        }
+        return 0;
+    }
+};
+
+TEST(anytime, ImprovesPlans) {
+    DummyTask task("0to10", {0}, {10});
+    ParityHeuristic heuristic;
+    std::vector<int> lengths;
+    AnytimeSearch search(task, heuristic, 0, [&](const std::vector<int>& plan) {
+        lengths.push_back((int)plan.size());
+    });
+    ASSERT_EQ(search.search().size(), 5);
+    std::vector<int> expected = {6, 5};
+    ASSERT_EQ(lengths, expected);
+    // every state is evaluated once across the restarts
+    ASSERT_LE(heuristic.evaluations, 11);
+
+    ZeroHeuristic zero;
+    DummyTask task2 = get_simple_search_space2();
+    ASSERT_EQ(anytime_search(task2, zero).size(), 4);
+    DummyTask task3 = get_search_no_solution();
+    ASSERT_EQ(anytime_search(task3, zero).size(), 0);
+}
+
+// Expands the initial state until the task stops generating successors
+std::vector<int> expand_until_stopped(BaseTask& task) {
+    while (true) {
+        int count = 0;
+        task.for_each_successor(task.initial_state,
+                                task.get_hash(task.initial_state),
+                                [&](const Successor&) { count++; });
+        if (count == 0) {
+            return {};
+        }
+    }
+}
+
+TEST(portfolio, FirstPlanCancelsOthers) {
+    DummyTask task = get_simple_search_space();
+    std::vector<PortfolioEntry> entries = {
+        {"forever", expand_until_stopped},
+        {"bfs", [](BaseTask& view) { return breadth_first_search(view); }},
+    };
+    Portfolio portfolio(entries);
+    ASSERT_EQ(portfolio.search(task).size(), 3);
+    ASSERT_EQ(portfolio.results[0].status, "cancelled");
+    ASSERT_GT(portfolio.results[0].expanded, 0);
+    ASSERT_EQ(portfolio.results[1].status, "solved");
+
+    DummyTask task2 = get_search_no_solution();
+    Portfolio portfolio2({{"slice", expand_until_stopped, 0.05},
+                          {"bfs", [](BaseTask& view) {
+                               return breadth_first_search(view);
+                           }}});
+    ASSERT_EQ(portfolio2.search(task2).size(), 0);
+    ASSERT_EQ(portfolio2.results[0].status, "timeout");
+    ASSERT_EQ(portfolio2.results[1].status, "failed");
+}
+
+TEST(enforced_hill_climbing, SearchAndFallBack) {
+    DummyTask task = get_simple_search_space();
+    DistanceHeuristic heuristic(10);
+    EnforcedHillClimbing search(task, heuristic);
+    ASSERT_EQ(search.search().size(), 3);
+    ASSERT_EQ(search.improvements, 3);
+
+    // only adding 2 gets stuck at 9
+    CountingHeuristic helpful(10, 2);
+    EnforcedHillClimbing restricted(task, helpful, true);
+    ASSERT_EQ(restricted.search().size(), 0);
+    ASSERT_TRUE(restricted.failed);
+    ASSERT_EQ(enforced_hill_climbing(task, helpful, true).size(), 3);
+
+    DummyTask task2 = get_search_no_solution();
+    ASSERT_EQ(enforced_hill_climbing(task2, heuristic).size(), 0);
+}
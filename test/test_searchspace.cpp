@@ -6,18 +6,16 @@
 
 #include "myplan/search/searchspace.h"
 
-flat_hash_set<int> state1 = {1};
-flat_hash_set<int> state2 = {2};
-flat_hash_set<int> state3 = {3};
-flat_hash_set<int> state4 = {4};
-flat_hash_set<int> state5 = {5};
-SearchNode root = make_root_node(state1);
-SearchNode child1 = make_child_node(0, root.g, 6, state2, root.hash_value);
-SearchNode child2 = make_child_node(0, root.g, 7, state3, root.hash_value);
-SearchNode grandchild1 =
-    make_child_node(1, child1.g, 8, state4, child1.hash_value);
-SearchNode grandchild2 =
-    make_child_node(2, child2.g, 9, state5, child2.hash_value);
+State state1 = {1};
+State state2 = {2};
+State state3 = {3};
+State state4 = {4};
+State state5 = {5};
+SearchNode root = make_root_node(0);
+SearchNode child1 = make_child_node(0, root.g, 6, 1);
+SearchNode child2 = make_child_node(0, root.g, 7, 2);
+SearchNode grandchild1 = make_child_node(1, child1.g, 8, 3);
+SearchNode grandchild2 = make_child_node(2, child2.g, 9, 4);
 
 TEST(searchspace, ExtractSolution) {
     std::vector<SearchNode> nodes = {root, child1, child2, grandchild1,
@@ -41,13 +39,23 @@ TEST(searchspace, GValues) {
 }
 
 TEST(searchspace, States) {
-    for (int s : root.state) {
+    ZobristTable zobrist(8);
+    SearchSpace space(1);
+    for (State* s : {&state1, &state2, &state3, &state4, &state5}) {
+        space.registry.insert(*s, zobrist.hash(*s));
+    }
+    for (const SearchNode& node :
+         {root, child1, child2, grandchild1, grandchild2}) {
+        space.add_node(node);
+    }
+    for (int s : space.state(0)) {
         ASSERT_EQ(s, 1);
     }
-    for (int s : child2.state) {
+    for (int s : space.state(2)) {
         ASSERT_EQ(s, 3);
     }
-    for (int s : grandchild1.state) {
+    for (int s : space.state(3)) {
         ASSERT_EQ(s, 4);
     }
+    ASSERT_EQ(extract_solution(4, space), std::vector<int>({7, 9}));
 }
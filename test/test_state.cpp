@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "myplan/state.h"
+
+TEST(State, InsertEraseContains) {
+    State s(130);
+    ASSERT_EQ(s.num_words(), 3);
+    ASSERT_TRUE(s.empty());
+    ASSERT_TRUE(s.insert(0));
+    ASSERT_TRUE(s.insert(64));
+    ASSERT_TRUE(s.insert(129));
+    ASSERT_FALSE(s.insert(64));
+    ASSERT_TRUE(s.contains(0));
+    ASSERT_TRUE(s.contains(129));
+    ASSERT_FALSE(s.contains(1));
+    ASSERT_FALSE(s.contains(500));
+    ASSERT_EQ(s.size(), 3);
+    ASSERT_TRUE(s.erase(64));
+    ASSERT_FALSE(s.erase(64));
+    ASSERT_EQ(s.size(), 2);
+}
+
+TEST(State, Iteration) {
+    State s = {3, 70, 1, 200};
+    std::vector<int> facts(s.begin(), s.end());
+    std::vector<int> expected = {1, 3, 70, 200};
+    ASSERT_EQ(facts, expected);
+    State e;
+    ASSERT_TRUE(e.begin() == e.end());
+}
+
+TEST(State, EqualityIgnoresWidth) {
+    State s1 = {1, 2};
+    State s2(300);
+    s2.insert(1);
+    s2.insert(2);
+    ASSERT_EQ(s1, s2);
+    s2.insert(256);
+    ASSERT_NE(s1, s2);
+    flat_hash_set<int> hs = {1, 2};
+    ASSERT_EQ(s1, hs);
+}
+
+TEST(State, WordWiseOperations) {
+    State goals = {1, 65};
+    State s = {1, 2, 65};
+    ASSERT_TRUE(goals.is_subset_of(s));
+    ASSERT_FALSE(s.is_subset_of(goals));
+    ASSERT_EQ(s.count_missing_in(goals), 1);
+
+    std::vector<WordMask> masks = make_word_masks({65, 1, 64});
+    ASSERT_EQ(masks.size(), 2);
+    ASSERT_EQ(masks[0].word, 0);
+    ASSERT_EQ(masks[1].bits, uint64_t(3));
+    ASSERT_FALSE(s.contains_all(masks));
+    s.insert(64);
+    ASSERT_TRUE(s.contains_all(masks));
+
+    s.set_difference(goals);
+    State expected = {2, 64};
+    ASSERT_EQ(s, expected);
+    s.set_union(goals);
+    expected = {1, 2, 64, 65};
+    ASSERT_EQ(s, expected);
+}
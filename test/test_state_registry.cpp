@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/search/state_registry.h"
+#include "myplan/task.h"
+
+TEST(StateRegistry, InternsEachStateOnce) {
+    ZobristTable zobrist(128);
+    StateRegistry registry(2);
+    State s1 = {1, 70};
+    State s2 = {2};
+    auto r1 = registry.insert(s1, zobrist.hash(s1));
+    auto r2 = registry.insert(s2, zobrist.hash(s2));
+    auto r3 = registry.insert(s1, zobrist.hash(s1));
+    ASSERT_TRUE(r1.second);
+    ASSERT_TRUE(r2.second);
+    ASSERT_FALSE(r3.second);
+    ASSERT_EQ(r1.first, r3.first);
+    ASSERT_NE(r1.first, r2.first);
+    ASSERT_EQ(registry.size(), 2);
+    ASSERT_TRUE(registry.lookup(r1.first) == s1.view());
+    ASSERT_EQ(registry.find(s2, zobrist.hash(s2)), r2.first);
+    State s3 = {3};
+    ASSERT_EQ(registry.find(s3, zobrist.hash(s3)), NO_STATE);
+    ASSERT_EQ(registry.size(), 2);
+}
+
+TEST(StateRegistry, PopBack) {
+    ZobristTable zobrist(128);
+    StateRegistry registry(2);
+    State s1 = {1, 70};
+    State s2 = {2};
+    registry.insert(s1, zobrist.hash(s1));
+    registry.insert(s2, zobrist.hash(s2));
+    registry.pop_back();
+    ASSERT_EQ(registry.size(), 1);
+    ASSERT_EQ(registry.find(s2, zobrist.hash(s2)), NO_STATE);
+    ASSERT_EQ(registry.find(s1, zobrist.hash(s1)), 0);
+    auto r = registry.insert(s2, zobrist.hash(s2));
+    ASSERT_TRUE(r.second);
+    ASSERT_EQ(r.first, 1);
+    ASSERT_TRUE(registry.lookup(1) == s2.view());
+}
+
+TEST(StateRegistry, CollidingHashesAreKeptApart) {
+    StateRegistry registry(1);
+    State s1 = {1};
+    State s2 = {2};
+    auto r1 = registry.insert(s1, 42);
+    auto r2 = registry.insert(s2, 42);
+    ASSERT_TRUE(r1.second);
+    ASSERT_TRUE(r2.second);
+    ASSERT_NE(r1.first, r2.first);
+    ASSERT_TRUE(registry.lookup(r2.first) == s2.view());
+    ASSERT_EQ(registry.find(s1, 42), r1.first);
+}
+
+TEST(StateRegistry, InsertsSuccessorsWithoutCopyingDuplicates) {
+    ZobristTable zobrist(128);
+    StateRegistry registry(2);
+    State s1 = {1, 70};
+    std::vector<int> pre = {1};
+    std::vector<int> add = {2};
+    std::vector<int> del = {70};
+    OperatorTable table;
+    table.add_operator(0, pre, add, del);
+    Successor succ{0, table.successor_hash(0, s1, zobrist.hash(s1), zobrist),
+                   s1, table.effect_masks(0)};
+    State s2 = {1, 2};
+    ASSERT_EQ(registry.find(succ), NO_STATE);
+    auto r1 = registry.insert(s2, zobrist.hash(s2));
+    ASSERT_EQ(registry.find(succ), r1.first);
+    auto r2 = registry.insert(succ);
+    ASSERT_FALSE(r2.second);
+    ASSERT_EQ(r2.first, r1.first);
+    ASSERT_EQ(registry.size(), 1);
+
+    Successor same{0, zobrist.hash(s1), s1, {}};
+    auto r3 = registry.insert(same);
+    ASSERT_TRUE(r3.second);
+    ASSERT_TRUE(registry.lookup(r3.first) == s1.view());
+}
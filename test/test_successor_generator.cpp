@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "myplan/successor_generator.h"
+
+TEST(SuccessorGenerator, ApplicableOperators) {
+    std::vector<std::vector<int>> pre = {{1, 2}, {2, 1, 3}, {}, {2, 3, 5}, {1}};
+    SuccessorGenerator generator(pre);
+
+    std::vector<int> result;
+    generator.get_applicable_operators(State({1, 2}), result);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, std::vector<int>({0, 2, 4}));
+
+    result.clear();
+    generator.get_applicable_operators(State({1, 2, 3, 5}), result);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, std::vector<int>({0, 1, 2, 3, 4}));
+
+    result.clear();
+    generator.get_applicable_operators(State(), result);
+    ASSERT_EQ(result, std::vector<int>({2}));
+}
+
+TEST(SuccessorGenerator, MatchesBruteForce) {
+    std::vector<std::vector<int>> pre;
+    for (int i = 0; i < 200; i++) {
+        std::vector<int> p;
+        for (int f = 0; f < 130; f += 7 + (i % 11)) {
+            if ((i * 31 + f) % 3 == 0) {
+                p.push_back((f + i) % 130);
+            }
+        }
+        pre.push_back(p);
+    }
+    SuccessorGenerator generator(pre);
+    for (int s = 0; s < 50; s++) {
+        State state(130);
+        for (int f = 0; f < 130; f++) {
+            if ((f * 17 + s * 13) % 5 != 0) {
+                state.insert(f);
+            }
+        }
+        std::vector<int> expected, result;
+        for (int i = 0; i < (int)pre.size(); i++) {
+            if (std::all_of(pre[i].begin(), pre[i].end(),
+                            [&](int f) { return state.contains(f); })) {
+                expected.push_back(i);
+            }
+        }
+        generator.get_applicable_operators(state, result);
+        std::sort(result.begin(), result.end());
+        ASSERT_EQ(result, expected);
+    }
+}
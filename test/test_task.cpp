@@ -6,9 +6,9 @@
 #include "myplan/task.h"
 
 TEST(EncodedOperatorTest, Applicable) {
-    flat_hash_set<int> s1 = {1};
-    flat_hash_set<int> s2 = {2};
-    flat_hash_set<int> s3 = {1, 2};
+    State s1 = {1};
+    State s2 = {2};
+    State s3 = {1, 2};
     std::vector<int> v1 = {1};
     std::vector<int> v2 = {2};
     std::vector<int> v3 = {};
@@ -19,23 +19,23 @@ TEST(EncodedOperatorTest, Applicable) {
 }
 
 TEST(EncodedOperatorTest, Application) {
-    flat_hash_set<int> s1 = {1};
-    flat_hash_set<int> s2 = {2};
-    flat_hash_set<int> s3 = {1, 2};
+    State s1 = {1};
+    State s2 = {2};
+    State s3 = {1, 2};
     std::vector<int> v1 = {1};
     std::vector<int> v2 = {2};
     std::vector<int> v3 = {};
     std::vector<int> v4 = {2};
     EncodedOperator op1(4, v1, v2, v3);
     EncodedOperator op4(4, v1, v2, v4);
-    ASSERT_EQ(op1.apply(s1, 1).second, s3);
-    ASSERT_EQ(op4.apply(s1, 1).second, s3);
+    ASSERT_EQ(op1.apply(s1), s3);
+    ASSERT_EQ(op4.apply(s1), s3);
 }
 
 TEST(EncodedOperatorTest, Successors) {
-    flat_hash_set<int> s1 = {1};
-    flat_hash_set<int> s2 = {2};
-    flat_hash_set<int> s3 = {1, 2};
+    State s1 = {1};
+    State s2 = {2};
+    State s3 = {1, 2};
     std::vector<int> v1 = {1};
     std::vector<int> v2 = {2};
     std::vector<int> v3 = {};
@@ -44,27 +44,75 @@ TEST(EncodedOperatorTest, Successors) {
     EncodedOperator op2(4, v1, v3, v4);
     EncodedOperator op3(4, v2, v1, v3);
     flat_hash_set<int> facts = {1, 2, 3};
-    flat_hash_set<int> init = {1};
+    State init = {1};
     std::set<int> init_set = {1};
     flat_hash_set<int> goals = {1, 2};
     std::vector<EncodedOperator> operators = {op1, op2, op3};
     Task task1("task1", facts, init, goals, operators);
 
-    std::vector<std::pair<EncodedOperator*, flat_hash_set<int>>> test_ss = {
+    std::vector<std::pair<EncodedOperator*, State>> test_ss = {
         {&op1, {1, 2}}, {&op2, {1}}};
-    std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>> ss;
+    std::vector<std::pair<int, pair<state_hash_t, State>>> ss;
     task1.get_successor_states(init, ss, 1);
     ASSERT_EQ(ss[0].first, test_ss[0].first->name);
     ASSERT_EQ(ss[1].first, test_ss[1].first->name);
     ASSERT_EQ(ss[0].second.second, test_ss[0].second);
     ASSERT_EQ(ss[1].second.second, test_ss[1].second);
-    flat_hash_set<int> test_v3 = {3};
+    State test_v3 = {3};
     ss.clear();
     task1.get_successor_states(test_v3, ss, 0);
     ASSERT_EQ(ss.size(), 0);
 
     ASSERT_FALSE(task1.goal_reached(init));
-    flat_hash_set<int> test_goal = {1, 2};
+    State test_goal = {1, 2};
     ASSERT_TRUE(task1.goal_reached(test_goal));
 }
 
+
+TEST(EncodedOperatorTest, SuccessorHashAndView) {
+    ZobristTable zobrist(130);
+    State s1 = {1, 70, 129};
+    std::vector<int> pre = {1};
+    std::vector<int> add = {2, 70, 128};
+    std::vector<int> del = {1, 129, 3};
+    EncodedOperator op(4, pre, add, del);
+    OperatorTable table;
+    table.add_operator(op.name, pre, add, del);
+    State expected = op.apply(s1);
+    state_hash_t h1 = zobrist.hash(s1);
+    ASSERT_EQ(table.successor_hash(0, s1, h1, zobrist),
+              zobrist.hash(expected));
+
+    Successor succ{op.name, table.successor_hash(0, s1, h1, zobrist), s1,
+                   table.effect_masks(0)};
+    ASSERT_EQ(succ.state(), expected);
+    ASSERT_TRUE(succ.equals(expected.words.data(), expected.num_words()));
+    ASSERT_FALSE(succ.equals(s1.words.data(), s1.num_words()));
+}
+
+TEST(EncodedOperatorTest, TaskSuccessorsMatchSuccessorStates) {
+    std::vector<int> v1 = {1};
+    std::vector<int> v2 = {2};
+    std::vector<int> v3 = {};
+    EncodedOperator op1(4, v1, v2, v3);
+    EncodedOperator op2(5, v1, v3, v1);
+    flat_hash_set<int> facts = {1, 2, 3};
+    State init = {1};
+    flat_hash_set<int> goals = {1, 2};
+    Task task1("task1", facts, init, goals, {op1, op2});
+
+    std::vector<std::pair<int, pair<state_hash_t, State>>> ss;
+    task1.get_successor_states(task1.initial_state,
+                               ss, task1.get_hash(task1.initial_state));
+    size_t i = 0;
+    task1.for_each_successor(
+        task1.initial_state, task1.get_hash(task1.initial_state),
+        [&](const Successor& succ) {
+            ASSERT_LT(i, ss.size());
+            ASSERT_EQ(succ.action, ss[i].first);
+            ASSERT_EQ(succ.hash, ss[i].second.first);
+            ASSERT_EQ(succ.state(), ss[i].second.second);
+            i++;
+        });
+    ASSERT_EQ(i, ss.size());
+}
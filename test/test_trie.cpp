@@ -68,3 +68,68 @@ TEST(settrie, KeyIsStringAndValueIsOperation) {
     std::vector<Operator*> groundtruth_3 = {};
     ASSERT_EQ(result_3, groundtruth_3);
 }
+
+TEST(settrie, CopyIsDeep) {
+    SetTrie<int, std::string> st;
+    st.assign({1, 2}, "A");
+    SetTrie<int, std::string> copied = st;
+    copied.assign({1}, "B");
+
+    std::set<int> query = {1, 2};
+    std::vector<std::string> groundtruth_st = {"A"};
+    std::vector<std::string> groundtruth_copied = {"B", "A"};
+    ASSERT_EQ(st.subsets(query), groundtruth_st);
+    ASSERT_EQ(copied.subsets(query), groundtruth_copied);
+}
+
+TEST(flatsettrie, KeyIsIntAndValueIsString) {
+    FlatSetTrie<int, std::string> st;
+    st.assign({1, 2}, "A");
+    st.assign({1, 2, 3}, "B");
+    st.assign({1, 2, 3}, "BB");
+    st.assign({2, 3, 5}, "C");
+
+    std::set<int> query_1 = {1, 2};
+    std::vector<std::string> result_1 = st.subsets(query_1);
+    std::vector<std::string> groundtruth_1 = {"A"};
+    ASSERT_EQ(result_1, groundtruth_1);
+
+    std::set<int> query_2 = {1, 2, 3};
+    std::vector<std::string> result_2 = st.subsets(query_2);
+    std::vector<std::string> groundtruth_2 = {"A", "B", "BB"};
+    ASSERT_EQ(result_2, groundtruth_2);
+
+    std::set<int> query_3 = {1, 3, 5};
+    std::vector<std::string> result_3 = st.subsets(query_3);
+    std::vector<std::string> groundtruth_3 = {};
+    ASSERT_EQ(result_3, groundtruth_3);
+
+    // assigning after a query rebuilds the pool
+    st.assign({}, "D");
+    st.assign({0, 5}, "E");
+    std::set<int> query_4 = {0, 2, 3, 5};
+    std::vector<std::string> result_4 = st.subsets(query_4);
+    std::vector<std::string> groundtruth_4 = {"D", "E", "C"};
+    ASSERT_EQ(result_4, groundtruth_4);
+}
+
+TEST(flatsettrie, BulkBuild) {
+    FlatSetTrie<std::string, int> st(
+        {{{"cond2", "cond3", "cond5"}, {3}},
+         {{"cond1", "cond2"}, {1, 11}},
+         {{"cond1", "cond2", "cond3"}, {2}}});
+    ASSERT_EQ(st.num_nodes(), 7);
+
+    std::set<std::string> query_1 = {"cond1", "cond2", "cond3"};
+    std::vector<int> groundtruth_1 = {1, 11, 2};
+    ASSERT_EQ(st.subsets(query_1), groundtruth_1);
+
+    std::set<std::string> query_2 = {"cond2", "cond3", "cond4", "cond5"};
+    std::vector<int> groundtruth_2 = {3};
+    ASSERT_EQ(st.subsets(query_2), groundtruth_2);
+
+    FlatSetTrie<std::string, int> copied = st;
+    std::vector<int> result;
+    copied.subsets(query_1, result);
+    ASSERT_EQ(result, groundtruth_1);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "myplan/task.h"
+#include "myplan/zobrist.h"
+
+TEST(Zobrist, RootHashIsXorOfKeys) {
+    ZobristTable zobrist(100);
+    State s = {3, 70, 99};
+    state_hash_t expected = zobrist.key(3);
+    expected ^= zobrist.key(70);
+    expected ^= zobrist.key(99);
+    ASSERT_TRUE(zobrist.hash(s) == expected);
+    ASSERT_TRUE(zobrist.hash(State()) == state_hash_t());
+}
+
+TEST(Zobrist, IncrementalHashMatchesRootHash) {
+    std::vector<int> pre = {1, 65};
+    std::vector<int> add = {2, 66};
+    std::vector<int> del = {1, 3};
+    OperatorTable table;
+    table.add_operator(0, pre, add, del);
+    ZobristTable zobrist(128);
+    State s = {1, 3, 65};
+    state_hash_t result = table.successor_hash(0, s, zobrist.hash(s), zobrist);
+    State expected = {2, 65, 66};
+    ASSERT_TRUE(result == zobrist.hash(expected));
+}
+
+TEST(Zobrist, WideKeys) {
+    BasicZobristTable<hash128_t> zobrist(64);
+    State s1 = {1, 2};
+    State s2 = {1, 3};
+    ASSERT_TRUE(zobrist.hash(s1) != zobrist.hash(s2));
+    ASSERT_NE(zobrist.key(1).hi, 0);
+    hash128_t h = zobrist.hash(s1);
+    h ^= zobrist.key(2);
+    ASSERT_TRUE(h == zobrist.key(1));
+}